@@ -1,511 +1,5764 @@
-// Trabalho 2 da disciplina de Programação de Software Básico
-// Eduardo Camana, Guilherme Specht e Isabella Cunha
-// Última atualização: 06/11/2024
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include "mymemory.h"
-
-// Função auxiliar para imprimir o estado atual da memória em ordem de endereços
-void print_memory_layout(mymemory_t *memory) 
-{
-    allocation_t *allocated = memory->allocated_blocks;  // Ponteiro para a lista de blocos alocados
-    allocation_t *free_blocks = memory->free_blocks;  // Ponteiro para a lista de blocos livres
-
-    // Criar uma lista de todos os blocos (alocados e livres) em ordem de endereços
-    allocation_t *all_blocks = NULL;  // Inicializa a lista combinada de blocos
-    allocation_t **tail = &all_blocks;  // Ponteiro para o final da lista combinada
-
-    while (allocated || free_blocks) 
-    {  
-        allocation_t **next_block = &free_blocks;  // Por padrão, escolhe um bloco livre
-        if (allocated && (!free_blocks || allocated->start < free_blocks->start)) 
-        {  
-            next_block = &allocated;  // Seleciona o bloco alocado
-        }
-
-        *tail = (allocation_t *)malloc(sizeof(allocation_t));  // Aloca um novo bloco na lista combinada
-        **tail = **next_block;  // Copia os dados do bloco selecionado para a nova entrada
-        (*tail)->next = NULL;  // Define o próximo do novo bloco como NULL
-
-        tail = &(*tail)->next;  // Move o ponteiro de cauda para o próximo
-        *next_block = (*next_block)->next;  // Avança para o próximo bloco na lista de origem
-    }
-
-    printf("\nEstado atual da memoria:\n");
-    printf("+----------------------+----------------------+----------+---------+\n");
-    printf("| Inicio               | Fim                  | Tamanho  | Estado  |\n");
-    printf("+----------------------+----------------------+----------+---------+\n");
-
-    allocation_t *current = all_blocks;  // Inicia a impressão da lista combinada
-    allocation_t *previous_free = NULL;  // Armazena o último bloco livre
-    unsigned long combined_size = 0;  // Tamanho combinado para blocos livres adjacentes
-    void *combined_start = NULL;  // Início combinado para blocos livres adjacentes
-
-    while (current) // Percorre todos os blocos
-    {  
-        const char *estado = "Livre";  // Assume que o bloco é livre
-        for (allocation_t *iter = memory->allocated_blocks; iter != NULL; iter = iter->next) 
-        {  
-            if (iter->start == current->start) 
-            {  
-                estado = "Alocado";  // Marca o bloco como alocado
-                break;
-            }
-        }
-
-        if (strcmp(estado, "Livre") == 0) // Se o bloco atual é livre
-        {  
-            if (previous_free && (char *)previous_free->start + previous_free->size == current->start) // Se o bloco livre atual é adjacente ao anterior
-            {  
-                combined_size += current->size;  // Atualiza o tamanho combinado
-            } 
-            else 
-            {  
-                if (previous_free) 
-                {  
-                    // Imprime o bloco livre combinado anterior
-                    printf("| 0x%-18p | 0x%-18p | %8lu | %-7s |\n",  
-                           combined_start,
-                           (char *)combined_start + combined_size - 1,
-                           combined_size,
-                           "Livre");
-                    printf("+----------------------+----------------------+----------+---------+\n");
-                }
-                // Inicia um novo bloco livre combinado
-                combined_start = current->start;
-                combined_size = current->size;
-            }
-            previous_free = current;  // Atualiza o bloco livre anterior
-        } 
-        else 
-        {  
-            if (previous_free) // Imprime o bloco livre combinado antes de mudar para alocado
-            {  
-                printf("| 0x%-18p | 0x%-18p | %8lu | %-7s |\n",  
-                       combined_start,
-                       (char *)combined_start + combined_size - 1,
-                       combined_size,
-                       "Livre");
-                printf("+----------------------+----------------------+----------+---------+\n");
-                previous_free = NULL;  // Reseta o bloco livre anterior
-            }
-            // Imprime o bloco alocado
-            printf("| 0x%-18p | 0x%-18p | %8lu | %-7s |\n",  
-                   current->start,
-                   (char *)current->start + current->size - 1,
-                   (unsigned long)current->size,
-                   estado);
-            printf("+----------------------+----------------------+----------+---------+\n");
-        }
-        current = current->next;  // Avança para o próximo bloco
-    }
-
-    if (previous_free) // Imprime o último bloco livre combinado, se existir
-    {  
-        printf("| 0x%-18p | 0x%-18p | %8lu | %-7s |\n",  
-               combined_start,
-               (char *)combined_start + combined_size - 1,
-               combined_size,
-               "Livre");
-        printf("+----------------------+----------------------+----------+---------+\n");
-    }
-
-    // Liberar a lista temporária
-    current = all_blocks;  // Reinicia o ponteiro para liberar os blocos combinados
-    while (current) // Libera cada bloco na lista combinada
-    {  
-        allocation_t *temp = current;
-        current = current->next;
-        free(temp);
-    }
-}
-
-// Estrutura para o pool de memória
-mymemory_t* mymemory_init(size_t size, AllocationStrategy strategy)
-{
-    mymemory_t *memory = (mymemory_t*)malloc(sizeof(mymemory_t)); // Aloca a estrutura de controle principal de memória
-    memory->pool = malloc(size); // Aloca o pool de memória total para uso
-    memory->total_size = size; // Define o tamanho total do pool de memória
-    memory->free_blocks = (allocation_t*)malloc(sizeof(allocation_t)); // Inicializa o primeiro bloco da lista de blocos livres
-    memory->free_blocks->start = memory->pool; // Define o início do bloco livre como o início do pool
-    memory->free_blocks->size = size; // Define o tamanho do bloco livre
-    memory->free_blocks->next = NULL; // Não há blocos livres adicionais, então o próximo é NULL
-    memory->allocated_blocks = NULL; // Inicialmente, não há blocos alocados
-    memory->strategy = strategy; // Define a estratégia de alocação (First Fit, Best Fit, Worst Fit)
-    return memory; // Retorna o ponteiro para a estrutura de controle de memória
-}
-
-// Função para alocar um bloco de memória
-void* mymemory_alloc(mymemory_t *memory, size_t size)
-{
-    allocation_t *current = memory->free_blocks;  // Ponteiro para percorrer os blocos livres
-    allocation_t *best_block = NULL;  // Melhor bloco na estratégia Best Fit
-    allocation_t **prev_best = NULL;  // Ponteiro para o bloco anterior ao melhor bloco
-    allocation_t **prev = &memory->free_blocks;  // Ponteiro para o bloco anterior na lista de blocos livres
-    void *allocated_start = NULL;  // Endereço do início do bloco alocado
-
-    switch (memory->strategy) // Seleciona a estratégia de alocação
-    {  
-        case FIRST_FIT: 
-            while (current) // Percorre a lista de blocos livres
-            {  
-                if (current->size >= size) // Verifica se o bloco atual é grande o suficiente
-                {  
-                    allocated_start = current->start;  // Armazena o início do bloco alocado
-                    *prev = current->next;  // Atualiza o ponteiro para o próximo bloco livre
-                    allocation_t *new_alloc = (allocation_t*)malloc(sizeof(allocation_t));  // Cria nova entrada para o bloco alocado
-                    new_alloc->start = allocated_start;  // Define o início do bloco alocado
-                    new_alloc->size = size;  // Define o tamanho do bloco alocado
-                    new_alloc->next = memory->allocated_blocks;  // Insere o bloco na lista de alocados
-                    memory->allocated_blocks = new_alloc;  // Atualiza o início da lista de alocados
-
-                    if (current->size > size) // Se o bloco livre é maior que o necessário
-                    {  
-                        current->start = (char*)current->start + size;  // Atualiza o início do bloco livre restante
-                        current->size -= size;  // Ajusta o tamanho do bloco livre restante
-                        current->next = memory->free_blocks;  // Reinsere o bloco restante na lista de livres
-                        memory->free_blocks = current;  // Atualiza o início da lista de livres
-                    } 
-                    else 
-                    {
-                        free(current);  // Libera o bloco se o tamanho for exatamente o necessário
-                    }
-                    return allocated_start;  // Retorna o endereço do início do bloco alocado
-                }
-                prev = &current->next;  // Avança para o próximo bloco
-                current = current->next;  // Avança o ponteiro
-            }
-            break;
-
-        case BEST_FIT: 
-            while (current) // Percorre a lista de blocos livres
-            {  
-                if (current->size >= size && (!best_block || current->size < best_block->size)) // Encontra o menor bloco adequado
-                {  
-                    best_block = current;  // Armazena o melhor bloco encontrado
-                    prev_best = prev;  // Atualiza o ponteiro para o bloco anterior
-                }
-                prev = &current->next;  // Avança o ponteiro para o próximo bloco
-                current = current->next;  // Avança o ponteiro
-            }
-            if (best_block) // Se um bloco adequado foi encontrado
-            {  
-                allocated_start = best_block->start;  // Define o início do bloco alocado
-                *prev_best = best_block->next;  // Atualiza o ponteiro do bloco anterior
-                allocation_t *new_alloc = (allocation_t*)malloc(sizeof(allocation_t));  // Cria novo bloco alocado
-                new_alloc->start = allocated_start;  // Define o início do bloco alocado
-                new_alloc->size = size;  // Define o tamanho do bloco alocado
-                new_alloc->next = memory->allocated_blocks;  // Insere o bloco na lista de alocados
-                memory->allocated_blocks = new_alloc;  // Atualiza o início da lista de alocados
-
-                if (best_block->size > size) // Se o bloco é maior que o necessário
-                {  
-                    best_block->start = (char*)best_block->start + size;  // Atualiza o início do bloco restante
-                    best_block->size -= size;  // Ajusta o tamanho do bloco restante
-                    best_block->next = memory->free_blocks;  // Reinsere o bloco restante na lista de livres
-                    memory->free_blocks = best_block;  // Atualiza o início da lista de livres
-                } 
-                else 
-                {
-                    free(best_block);  // Libera o bloco se o tamanho for exatamente o necessário
-                }
-                return allocated_start;  // Retorna o endereço do início do bloco alocado
-            }
-            break;
-
-        case WORST_FIT: {
-            allocation_t *worst_block = NULL;  // Maior bloco na estratégia Worst Fit
-            allocation_t **prev_worst = NULL;  // Ponteiro para o bloco anterior ao maior bloco
-            current = memory->free_blocks;  // Recomeça a percorrer os blocos livres
-            prev = &memory->free_blocks;  // Reinicia o ponteiro para o bloco anterior
-
-            while (current) // Percorre a lista de blocos livres
-            {  
-                if (current->size >= size && (!worst_block || current->size > worst_block->size)) // Encontra o maior bloco adequado
-                {  
-                    worst_block = current;  // Armazena o pior bloco encontrado
-                    prev_worst = prev;  // Atualiza o ponteiro para o bloco anterior
-                }
-                prev = &current->next;  // Avança o ponteiro para o próximo bloco
-                current = current->next;  // Avança o ponteiro
-            }
-            if (worst_block) // Se um bloco adequado foi encontrado
-            {  
-                allocated_start = worst_block->start;  // Define o início do bloco alocado
-                *prev_worst = worst_block->next;  // Atualiza o ponteiro do bloco anterior
-                allocation_t *new_alloc = (allocation_t*)malloc(sizeof(allocation_t));  // Cria novo bloco alocado
-                new_alloc->start = allocated_start;  // Define o início do bloco alocado
-                new_alloc->size = size;  // Define o tamanho do bloco alocado
-                new_alloc->next = memory->allocated_blocks;  // Insere o bloco na lista de alocados
-                memory->allocated_blocks = new_alloc;  // Atualiza o início da lista de alocados
-
-                if (worst_block->size > size) // Se o bloco é maior que o necessário
-                {  
-                    worst_block->start = (char*)worst_block->start + size;  // Atualiza o início do bloco restante
-                    worst_block->size -= size;  // Ajusta o tamanho do bloco restante
-                    worst_block->next = memory->free_blocks;  // Reinsere o bloco restante na lista de livres
-                    memory->free_blocks = worst_block;  // Atualiza o início da lista de livres
-                } 
-                else 
-                {
-                    free(worst_block);  // Libera o bloco se o tamanho for exatamente o necessário
-                }
-                return allocated_start;  // Retorna o endereço do início do bloco alocado
-            }
-            break;
-        }
-    }
-    return NULL;  // Retorna NULL se nenhum bloco adequado foi encontrado
-}
-
-
-// Função para liberar memória
-void mymemory_free(mymemory_t *memory, void *ptr) 
-{
-    allocation_t *current = memory->allocated_blocks; // Ponteiro para percorrer a lista de blocos alocados
-    allocation_t *prev = NULL; // Armazena o bloco anterior
-
-    // Verifica se o endereço passado é o início de um bloco alocado
-    int found = 0; // Variável de controle para identificar se o bloco foi encontrado
-    while (current) 
-    {
-        if (current->start == ptr) // Confirma que o endereço é o início do bloco
-        {
-            found = 1; // Marca como encontrado
-            break;
-        }
-        prev = current;
-        current = current->next;
-    }
-
-    if (!found) 
-    {
-        printf("O endereco fornecido nao corresponde ao inicio de um bloco alocado.\n");
-    }
-    else
-    {
-        // Se o bloco foi encontrado, libera o bloco
-        if (prev) 
-        {
-            prev->next = current->next; // Remove o bloco da lista de alocados
-        } 
-        else 
-        {
-            memory->allocated_blocks = current->next; // Atualiza o início da lista alocada, se o bloco era o primeiro
-        }
-
-        current->next = memory->free_blocks; // Reinsere o bloco liberado na lista de livres
-        memory->free_blocks = current; // Atualiza o início da lista de blocos livres
-        printf("Memoria no endereco 0x%p liberada.\n", ptr); // Mensagem de sucesso
-    }
-}
-
-
-// Exibe alocações atuais
-void mymemory_display(mymemory_t *memory) 
-{
-    allocation_t *current = memory->allocated_blocks; // Ponteiro para iterar sobre os blocos alocados
-    printf("Alocacoes atuais:\n");
-
-    while (current) // Percorre a lista de blocos alocados
-    { 
-        printf("Inicio: 0x%p, Tamanho: %lu\n", current->start, (unsigned long)current->size); // Imprime endereço e tamanho
-        current = current->next; // Avança para o próximo bloco
-    }
-}
-
-// Exibe estatísticas de memória
-void mymemory_stats(mymemory_t *memory) 
-{
-    allocation_t *current = memory->allocated_blocks;  // Ponteiro para iterar sobre os blocos alocados
-    unsigned long total_allocated = 0;  // Inicializa o total de memória alocada
-    int alloc_count = 0;  // Inicializa o contador de alocações
-
-    while (current) // Percorre a lista de blocos alocados
-    {  
-        total_allocated += current->size;  // Acumula o tamanho dos blocos alocados
-        alloc_count++;  // Incrementa o contador de alocações
-        current = current->next;  // Avança para o próximo bloco
-    }
-
-    unsigned long total_free = memory->total_size - total_allocated;  // Calcula a memória livre
-
-    // Estatísticas adicionais
-    current = memory->free_blocks;  // Ponteiro para iterar sobre os blocos livres
-    unsigned long max_free_block = 0;  // Maior bloco contíguo de memória livre
-    unsigned long current_contiguous_size = 0;
-    void *previous_end = NULL;
-    int free_fragments = 0;  // Número de fragmentos de memória livre
-
-    while (current) // Percorre a lista de blocos livres
-    {  
-        if (previous_end && (char *)previous_end + 1 == current->start) 
-        {
-            current_contiguous_size += current->size;  // Bloco contíguo encontrado
-        } else {
-            if (current_contiguous_size > max_free_block) // Novo bloco começa, finalize o bloco anterior
-            {
-                max_free_block = current_contiguous_size;
-            }
-            current_contiguous_size = current->size;  // Inicia novo bloco contíguo
-            free_fragments++;  // Conta o novo fragmento
-        }
-        previous_end = (char *)current->start + current->size - 1;
-        current = current->next;  // Avança para o próximo bloco
-    }
-
-    if (current_contiguous_size > max_free_block) // Finalizar verificação do último bloco contíguo
-    {
-        max_free_block = current_contiguous_size;
-    }
-
-    // Exibe estatísticas de memória
-    printf("Estatisticas de memoria:\n");
-    printf("Total de alocacoes: %d\n", alloc_count);
-    printf("Memoria total alocada: %lu bytes\n", total_allocated);
-    printf("Memoria total livre: %lu bytes\n", total_free);
-    printf("Maior bloco livre contiguo: %lu bytes\n", max_free_block);
-    printf("Numero de fragmentos de memoria livre: %d\n", free_fragments);
-}
-
-// Limpa memória e libera recursos
-void mymemory_cleanup(mymemory_t *memory) 
-{
-    allocation_t *current = memory->allocated_blocks; // Libera todos os blocos alocados
-    while (current) 
-    {
-        allocation_t *temp = current; // Armazena o bloco atual
-        current = current->next; // Avança para o próximo bloco
-        free(temp); // Libera o bloco atual
-    }
-    current = memory->free_blocks; // Libera todos os blocos livres
-    while (current) 
-    {
-        allocation_t *temp = current; // Armazena o bloco atual
-        current = current->next; // Avança para o próximo bloco
-        free(temp); // Libera o bloco atual
-    }
-    free(memory->pool); // Libera o pool de memória
-    free(memory); // Libera a estrutura de controle principal
-}
-
-void display_menu() {
-    printf("\n--- Menu de Gerenciamento de Memoria ---\n");
-    printf("1. Inicializar memoria\n");
-    printf("2. Alocar memoria\n");
-    printf("3. Liberar memoria\n");
-    printf("4. Exibir alocacoes atuais\n");
-    printf("5. Exibir estatisticas de memoria\n");
-    printf("6. Layout da memoria\n");
-    printf("7. Limpar memoria e sair\n");
-    printf("Escolha uma opcao: ");
-}
-
-int main() {
-    mymemory_t *memory = NULL;
-    AllocationStrategy strategy;
-    size_t pool_size, alloc_size;
-    int option;
-    void *allocated_ptr;
-
-    while (1) 
-    {
-        display_menu();
-        scanf("%d", &option);
-
-        switch (option) {
-            case 1: // Inicializar memória
-                if (memory != NULL) 
-                {
-                    printf("Memoria ja foi inicializada. Limpe antes de reinicializar.\n");
-                    break;
-                }
-                printf("Digite o tamanho do pool de memoria: ");
-                scanf("%zu", &pool_size);
-                printf("Escolha a estrategia de alocacao (0: First Fit, 1: Best Fit, 2: Worst Fit): ");
-                int strat_option;
-                scanf("%d", &strat_option);
-
-                strategy = (strat_option == 1) ? BEST_FIT : (strat_option == 2) ? WORST_FIT : FIRST_FIT;
-                memory = mymemory_init(pool_size, strategy);
-                printf("Memoria inicializada com %zu bytes usando a estrategia %s.\n",
-                       pool_size, (strategy == BEST_FIT ? "Best Fit" : (strategy == WORST_FIT ? "Worst Fit" : "First Fit")));
-                break;
-
-            case 2: // Alocar memória
-                if (memory == NULL) 
-                {
-                    printf("Inicialize a memoria primeiro.\n");
-                    break;
-                }
-                printf("Digite o tamanho do bloco a ser alocado: ");
-                scanf("%zu", &alloc_size);
-                allocated_ptr = mymemory_alloc(memory, alloc_size);
-
-                if (allocated_ptr != NULL) 
-                {
-                    printf("Memoria alocada no endereco 0x%p.\n", allocated_ptr);
-                } 
-                else 
-                {
-                    printf("Falha ao alocar memoria. Tente um tamanho menor ou verifique o pool disponivel.\n");
-                }
-                break;
-
-            case 3: // Liberar memória
-                if (memory == NULL) 
-                {
-                    printf("Inicialize a memoria primeiro.\n");
-                    break;
-                }
-                printf("Digite o endereco (em hexadecimal sem o '0x') do bloco a ser liberado: ");
-                scanf("%p", &allocated_ptr);
-                mymemory_free(memory, allocated_ptr);
-                // printf("Memoria no endereco 0x%p liberada.\n", allocated_ptr);
-                break;
-
-            case 4: // Exibir alocações atuais
-                if (memory == NULL) 
-                {
-                    printf("Inicialize a memoria primeiro.\n");
-                    break;
-                }
-                mymemory_display(memory);
-                break;
-
-            case 5: // Exibir estatísticas de memória
-                if (memory == NULL) 
-                {
-                    printf("Inicialize a memoria primeiro.\n");
-                    break;
-                }
-                mymemory_stats(memory);
-                break;
-
-            case 6: // Exibir layout da memória
-                if (memory == NULL) 
-                {
-                    printf("Inicialize a memoria primeiro.\n");
-                    break;
-                }
-                print_memory_layout(memory);  // Chamada para exibir o layout da memória
-                break;
-
-            case 7: // Limpar memória e sair
-                if (memory != NULL) 
-                {
-                    mymemory_cleanup(memory);
-                    printf("Memoria limpa e todos os recursos liberados.\n");
-                }
-                printf("Encerrando programa.\n");
-                return 0;
-
-            default:
-                printf("Opcao invalida. Tente novamente.\n");
-                break;
-        }
-    }
-    return 0;
-}
+// Trabalho 2 da disciplina de Programação de Software Básico
+// Eduardo Camana, Guilherme Specht e Isabella Cunha
+// Última atualização: 06/11/2024
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include "mymemory.h"
+
+// Calcula a posição de um endereço no índice (um slot por unidade de alocação do pool)
+static size_t index_slot(mymemory_t *memory, void *ptr)
+{
+    return (size_t)((char *)ptr - (char *)memory->pool) >> memory->alignment_shift;  // Deslocamento em unidades de alocação
+}
+
+// Procura o bloco alocado que começa em "ptr" em O(1)
+static allocation_t *index_find(mymemory_t *memory, void *ptr)
+{
+    if ((char *)ptr < (char *)memory->pool || (char *)ptr >= (char *)memory->pool + memory->total_size)
+    {
+        return NULL;  // Endereço fora do pool
+    }
+
+    allocation_t *block = memory->index_slots[index_slot(memory, ptr)];
+    if (block && block->start == ptr) // O endereço precisa ser exatamente o início do bloco
+    {
+        return block;
+    }
+    return NULL;  // Não existe bloco alocado começando nesse endereço
+}
+
+// Registra um bloco alocado no índice
+static void index_insert(mymemory_t *memory, allocation_t *block)
+{
+    memory->index_slots[index_slot(memory, block->start)] = block;
+    memory->index_count++;
+}
+
+// Remove um bloco do índice
+static void index_remove(mymemory_t *memory, allocation_t *block)
+{
+    memory->index_slots[index_slot(memory, block->start)] = NULL;
+    memory->index_count--;
+}
+
+// Obtém uma entrada livre do slab de descritores (nenhuma chamada a malloc)
+static allocation_t *descriptor_acquire(mymemory_t *memory)
+{
+    allocation_t *descriptor = memory->free_descriptors;  // Reaproveita uma entrada devolvida
+
+    if (descriptor)
+    {
+        memory->free_descriptors = descriptor->next;
+    }
+    else
+    {
+        descriptor = &memory->descriptors[memory->descriptors_used++];  // Usa a próxima entrada nunca tocada
+    }
+    return descriptor;
+}
+
+// Devolve uma entrada ao slab de descritores
+static void descriptor_release(mymemory_t *memory, allocation_t *descriptor)
+{
+    descriptor->next = memory->free_descriptors;
+    memory->free_descriptors = descriptor;
+}
+
+// Trava o pool compartilhado (apenas no modo concorrente)
+static void pool_lock(mymemory_t *memory)
+{
+    if (memory->concurrent)
+    {
+        pthread_mutex_lock(&memory->lock);
+    }
+}
+
+// Destrava o pool compartilhado (apenas no modo concorrente)
+static void pool_unlock(mymemory_t *memory)
+{
+    if (memory->concurrent)
+    {
+        pthread_mutex_unlock(&memory->lock);
+    }
+}
+
+// Cache de blocos pequenos de uma thread em um pool
+// Os blocos continuam alocados do ponto de vista do pool (owner = slot + 1) e são encadeados pelo próprio conteúdo
+struct mymemory_thread_cache {
+    void *bins[MYMEMORY_CACHE_CLASSES];  // Pilha de blocos livres por classe de tamanho
+    unsigned counts[MYMEMORY_CACHE_CLASSES];  // Quantidade de blocos em cada pilha
+    _Atomic(void *) remote_frees;  // Blocos deste cache liberados por outras threads (pilha sem lock)
+} __attribute__((aligned(64)));  // Uma linha de cache própria por thread, sem falso compartilhamento
+
+// Fila de liberações adiadas de uma thread em um pool: só a thread dona escreve (tail) e só quem drena lê (head)
+// Cada lado fica na sua linha de cache, para que enfileirar não dispute a linha com a thread de manutenção
+struct mymemory_defer_queue {
+    struct {
+        _Atomic size_t tail;  // Próxima posição a escrever (só a thread dona avança)
+        size_t head_cache;  // Última posição de leitura vista pela thread dona: evita ler "head" a cada liberação
+    } __attribute__((aligned(64))) producer;
+    struct {
+        _Atomic size_t head;  // Próxima posição a drenar (só quem segura defer_lock avança)
+    } __attribute__((aligned(64))) consumer;
+    void *ptrs[MYMEMORY_DEFER_QUEUE];  // Endereços a liberar (índices módulo MYMEMORY_DEFER_QUEUE)
+};
+
+// Página do pool na estratégia Slab (metadados fora do pool, um registro por página)
+struct mymemory_slab_page {
+    uint64_t free_slots[MYMEMORY_SLAB_PAGE / MYMEMORY_GRANULE / 64];  // Um bit por posição de objeto: ligado = livre
+    int32_t next_partial;  // Próxima página parcialmente ocupada da mesma classe (-1 = nenhuma)
+    int32_t prev_partial;  // Página parcialmente ocupada anterior da mesma classe (-1 = nenhuma)
+    uint32_t run;  // Páginas da sequência (objetos grandes)
+    uint16_t used;  // Objetos em uso na página
+    uint8_t kind;  // SLAB_PAGE_*
+    uint8_t cls;  // Classe de tamanho dos objetos da página
+};
+
+// Nó da árvore de segmentos sobre as páginas do Slab: sequências de páginas livres no trecho coberto pelo nó
+struct mymemory_slab_run {
+    uint32_t prefix;  // Páginas livres no início do trecho
+    uint32_t suffix;  // Páginas livres no fim do trecho
+    uint32_t best;  // Maior sequência de páginas livres dentro do trecho
+};
+
+#define SLAB_PAGE_FREE 0  // Página livre
+#define SLAB_PAGE_OBJECTS 1  // Página dividida em objetos de uma classe
+#define SLAB_PAGE_LARGE 2  // Primeira página de um objeto grande
+#define SLAB_PAGE_LARGE_TAIL 3  // Demais páginas de um objeto grande
+
+// Tamanho dos objetos de uma classe (16, 32, 64, ..., MYMEMORY_SLAB_MAX_SIZE)
+static size_t slab_class_size(int cls)
+{
+    return (size_t)MYMEMORY_GRANULE << cls;
+}
+
+static void segregated_insert(mymemory_t *memory, allocation_t *block);
+static int slab_init(mymemory_t *memory);
+static int slab_runs_init(mymemory_t *memory);
+static void slab_runs_build(mymemory_t *memory);
+static int buddy_init(mymemory_t *memory);
+static int current_thread_slot(void);
+static int defer_start(mymemory_t *memory);
+static void refresh_largest_free(mymemory_t *memory);
+
+#ifdef MYMEMORY_INSTRUMENT
+// Contadores de instrumentação de uma thread em um pool: só a própria thread escreve, o dump apenas lê
+struct mymemory_instrument {
+    _Atomic uint64_t alloc[MYMEMORY_INSTRUMENT_CLASSES][MYMEMORY_INSTRUMENT_BUCKETS];  // Alocações por classe de tamanho e faixa de latência
+    _Atomic uint64_t free[MYMEMORY_INSTRUMENT_CLASSES][MYMEMORY_INSTRUMENT_BUCKETS];  // Liberações por classe de tamanho e faixa de latência
+    _Atomic uint64_t alloc_search[MYMEMORY_INSTRUMENT_BUCKETS];  // Blocos livres examinados por alocação (First/Best/Worst Fit e TLSF)
+    _Atomic uint64_t free_search[MYMEMORY_INSTRUMENT_BUCKETS];  // Blocos livres percorridos para inserir em ordem de endereços
+} __attribute__((aligned(64)));  // Sem falso compartilhamento entre threads
+
+#define INSTRUMENT_DECLARE(name) size_t name = 0  // Contador local de passos de busca
+#define INSTRUMENT_STEP(name) ((name)++)
+#define INSTRUMENT_SEARCH(memory, which, steps) instrument_search(memory, which, steps)
+#define INSTRUMENT_BEGIN(start) uint64_t start = instrument_now()  // Início de uma operação medida
+#define INSTRUMENT_END(memory, which, size, start) instrument_record(memory, which, size, start)
+
+// Faixa logarítmica de um valor: 0 -> 0, 1 -> 1, 2..3 -> 2, 4..7 -> 3, ...
+static unsigned instrument_bucket(uint64_t value)
+{
+    unsigned bucket = value ? 64 - (unsigned)__builtin_clzll(value) : 0;
+    return bucket < MYMEMORY_INSTRUMENT_BUCKETS ? bucket : MYMEMORY_INSTRUMENT_BUCKETS - 1;
+}
+
+// Classe de tamanho: 0 para até 16 bytes, 1 para até 32, ... (a última inclui todos os maiores)
+static unsigned instrument_class(size_t size)
+{
+    unsigned cls = size > MYMEMORY_GRANULE ? 64 - (unsigned)__builtin_clzll(size - 1) - (unsigned)__builtin_ctz(MYMEMORY_GRANULE) : 0;
+    return cls < MYMEMORY_INSTRUMENT_CLASSES ? cls : MYMEMORY_INSTRUMENT_CLASSES - 1;
+}
+
+// Incrementa um contador que só a thread dona escreve (sem instrução atômica de leitura-modificação-escrita)
+static void instrument_add(_Atomic uint64_t *counter)
+{
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+// Contadores da thread atual no pool (NULL se a thread não conseguiu um slot)
+static struct mymemory_instrument *instrument_local(mymemory_t *memory)
+{
+    int slot = current_thread_slot();
+    return slot >= 0 && memory->instrument ? &memory->instrument[slot] : NULL;
+}
+
+// Relógio monotônico em nanossegundos
+static uint64_t instrument_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+// Registra uma alocação (which = 0) ou liberação (which = 1) de "size" bytes iniciada em "start"
+static void instrument_record(mymemory_t *memory, int which, size_t size, uint64_t start)
+{
+    uint64_t elapsed = instrument_now() - start;
+    struct mymemory_instrument *local = instrument_local(memory);
+    if (local)
+    {
+        instrument_add(&(which ? local->free : local->alloc)[instrument_class(size)][instrument_bucket(elapsed)]);
+    }
+}
+
+// Registra quantos blocos livres uma busca examinou (which = 0: alocação, 1: inserção na liberação)
+static void instrument_search(mymemory_t *memory, int which, size_t steps)
+{
+    struct mymemory_instrument *local = instrument_local(memory);
+    if (local)
+    {
+        instrument_add(&(which ? local->free_search : local->alloc_search)[instrument_bucket(steps)]);
+    }
+}
+#else
+#define INSTRUMENT_DECLARE(name)  // Sem instrumentação: nada é declarado, contado ou medido
+#define INSTRUMENT_STEP(name)
+#define INSTRUMENT_SEARCH(memory, which, steps)
+#define INSTRUMENT_BEGIN(start)
+#define INSTRUMENT_END(memory, which, size, start)
+#endif
+
+// Contabiliza "size" bytes que passaram a estar em uso, acompanhando o pico
+static void stats_in_use_add(mymemory_t *memory, size_t size)
+{
+    memory->counters.bytes_in_use += size;
+    if (memory->counters.bytes_in_use > memory->counters.peak_bytes_in_use)
+    {
+        memory->counters.peak_bytes_in_use = memory->counters.bytes_in_use;
+    }
+}
+
+// Um trecho livre de "size" bytes entrou nas estruturas de livres
+static void stats_free_added(mymemory_t *memory, size_t size)
+{
+    memory->counters.free_blocks++;
+    if (size > memory->counters.largest_free_block)
+    {
+        memory->counters.largest_free_block = size;  // Continua exato: só cresceu
+    }
+}
+
+// Um trecho livre de "size" bytes saiu das estruturas de livres
+static void stats_free_removed(mymemory_t *memory, size_t size)
+{
+    memory->counters.free_blocks--;
+    if (size >= memory->counters.largest_free_block)
+    {
+        memory->largest_free_dirty = 1;  // Pode ter sido o maior: recalcula na próxima consulta
+    }
+}
+
+// Zera as estatísticas do conteúdo do pool; o pico e as falhas são históricos e continuam
+static void stats_reset(mymemory_t *memory)
+{
+    memory->counters.bytes_in_use = 0;
+    memory->counters.allocated_blocks = 0;
+    memory->counters.free_blocks = 0;
+    memory->counters.largest_free_block = 0;
+    memory->largest_free_dirty = 0;
+}
+
+// Nó da árvore B+ de blocos livres ordenada por (tamanho, endereço), usada por Best Fit e Worst Fit
+// As chaves ficam em vetores contíguos: a busca dentro de um nó percorre poucas linhas de cache sem tocar nos descritores
+struct mymemory_size_node {
+    size_t size[MYMEMORY_SIZE_FANOUT];  // Tamanho dos blocos (folha) ou limite inferior de cada filho (nó interno; o primeiro não é usado)
+    char *start[MYMEMORY_SIZE_FANOUT];  // Endereço: desempate entre blocos do mesmo tamanho
+    void *item[MYMEMORY_SIZE_FANOUT];  // Folha: descritor do bloco livre; nó interno: filho
+    struct mymemory_size_node *next;  // Folha seguinte em ordem crescente (NULL na última)
+    struct mymemory_size_node *prev;  // Folha anterior (NULL na primeira)
+    uint32_t count;  // Chaves (folha) ou filhos (nó interno)
+    uint32_t leaf;  // 1 se é folha
+};
+
+#define SIZE_MIN_FILL (MYMEMORY_SIZE_FANOUT / 2)  // Ocupação mínima de um nó que não é a raiz
+
+// Compara a chave (size, start) com a posição "i" de um nó: negativo, zero ou positivo
+static int size_key_compare(size_t size, const char *start, const struct mymemory_size_node *node, uint32_t i)
+{
+    if (size != node->size[i])
+    {
+        return size < node->size[i] ? -1 : 1;
+    }
+    return start < node->start[i] ? -1 : start > node->start[i];
+}
+
+// Filho de um nó interno cuja faixa contém a chave: o último com limite inferior <= chave
+static uint32_t size_child_index(const struct mymemory_size_node *node, size_t size, const char *start)
+{
+    uint32_t i = 1;
+    while (i < node->count && size_key_compare(size, start, node, i) >= 0)
+    {
+        i++;
+    }
+    return i - 1;
+}
+
+// Obtém um nó da reserva feita no mymemory_init (nenhuma chamada a malloc)
+static struct mymemory_size_node *size_node_acquire(mymemory_t *memory, int leaf)
+{
+    struct mymemory_size_node *node = memory->size_free_nodes;
+    if (node)
+    {
+        memory->size_free_nodes = node->next;
+    }
+    else
+    {
+        node = &memory->size_nodes[memory->size_nodes_used++];
+    }
+    node->count = 0;
+    node->leaf = (uint32_t)leaf;
+    node->next = NULL;
+    node->prev = NULL;
+    return node;
+}
+
+// Devolve um nó à reserva
+static void size_node_release(mymemory_t *memory, struct mymemory_size_node *node)
+{
+    node->next = memory->size_free_nodes;
+    memory->size_free_nodes = node;
+}
+
+// Árvore vazia: só uma folha sem chaves
+static void size_tree_reset(mymemory_t *memory)
+{
+    memory->size_nodes_used = 0;
+    memory->size_free_nodes = NULL;
+    memory->size_root = size_node_acquire(memory, 1);
+}
+
+// Nós que bastam para "descriptors" descritores: os blocos livres nunca são vizinhos, então há no máximo metade deles livres
+static size_t size_tree_capacity(size_t descriptors)
+{
+    size_t max_free = descriptors / 2 + 1;
+    return (max_free / SIZE_MIN_FILL + 2) * 2 + 16;  // Folhas com ocupação mínima e os níveis acima delas
+}
+
+static void *table_reserve(size_t bytes);
+static int tables_commit(mymemory_t *memory, size_t size);
+
+// Reserva os nós da árvore (no pool crescente, só a faixa de endereços); retorna 0 se faltar memória
+static int size_tree_init(mymemory_t *memory)
+{
+    memory->size_node_capacity = size_tree_capacity(memory->descriptor_capacity);
+    size_t bytes = memory->size_node_capacity * sizeof(struct mymemory_size_node);
+    memory->size_nodes = (struct mymemory_size_node *)(memory->region_size ? table_reserve(bytes) : malloc(bytes));
+    if (!memory->size_nodes || (memory->region_size && !tables_commit(memory, memory->total_size)))
+    {
+        return 0;
+    }
+    size_tree_reset(memory);
+    return 1;
+}
+
+// Abre espaço na posição "i" de um nó (laços curtos: os nós são pequenos demais para valer uma chamada a memmove)
+static void size_node_shift(struct mymemory_size_node *node, uint32_t i)
+{
+    for (uint32_t j = node->count; j > i; j--)
+    {
+        node->size[j] = node->size[j - 1];
+        node->start[j] = node->start[j - 1];
+        node->item[j] = node->item[j - 1];
+    }
+    node->count++;
+}
+
+// Remove a posição "i" de um nó
+static void size_node_erase(struct mymemory_size_node *node, uint32_t i)
+{
+    node->count--;
+    for (uint32_t j = i; j < node->count; j++)
+    {
+        node->size[j] = node->size[j + 1];
+        node->start[j] = node->start[j + 1];
+        node->item[j] = node->item[j + 1];
+    }
+}
+
+// Copia "count" posições de um nó para outro
+static void size_node_copy(struct mymemory_size_node *to, uint32_t to_i, const struct mymemory_size_node *from, uint32_t from_i, uint32_t count)
+{
+    memcpy(&to->size[to_i], &from->size[from_i], count * sizeof(to->size[0]));
+    memcpy(&to->start[to_i], &from->start[from_i], count * sizeof(to->start[0]));
+    memcpy(&to->item[to_i], &from->item[from_i], count * sizeof(to->item[0]));
+}
+
+// Divide um nó cheio ao meio; a metade de cima vai para um nó novo, que é retornado
+static struct mymemory_size_node *size_node_split(mymemory_t *memory, struct mymemory_size_node *node)
+{
+    struct mymemory_size_node *right = size_node_acquire(memory, (int)node->leaf);
+    right->count = node->count - MYMEMORY_SIZE_FANOUT / 2;
+    size_node_copy(right, 0, node, MYMEMORY_SIZE_FANOUT / 2, right->count);
+    node->count = MYMEMORY_SIZE_FANOUT / 2;
+    if (node->leaf) // Mantém o encadeamento das folhas em ordem
+    {
+        right->next = node->next;
+        right->prev = node;
+        if (node->next)
+        {
+            node->next->prev = right;
+        }
+        node->next = right;
+    }
+    return right;  // size[0]/start[0] de "right" é o limite inferior da nova metade
+}
+
+// Insere a chave em uma subárvore; se o nó precisou ser dividido, retorna a nova metade direita
+static struct mymemory_size_node *size_insert_into(mymemory_t *memory, struct mymemory_size_node *node, allocation_t *block)
+{
+    size_t size = block->size;
+    char *start = (char *)block->start;
+    struct mymemory_size_node *right = NULL;
+    void *item = block;
+    uint32_t i;
+
+    if (node->leaf)
+    {
+        for (i = 0; i < node->count && size_key_compare(size, start, node, i) > 0; i++)
+        {
+        }
+    }
+    else
+    {
+        i = size_child_index(node, size, start);
+        struct mymemory_size_node *child = size_insert_into(memory, (struct mymemory_size_node *)node->item[i], block);
+        if (!child)
+        {
+            return NULL;
+        }
+        size = child->size[0];  // O filho novo entra logo depois do que foi dividido
+        start = child->start[0];
+        item = child;
+        i++;
+    }
+
+    if (node->count == MYMEMORY_SIZE_FANOUT) // Cheio: divide antes de inserir
+    {
+        right = size_node_split(memory, node);
+        if (i > node->count)
+        {
+            i -= node->count;
+            node = right;
+        }
+    }
+    size_node_shift(node, i);
+    node->size[i] = size;
+    node->start[i] = start;
+    node->item[i] = item;
+    return right;
+}
+
+// Acrescenta um bloco livre à árvore
+static void size_tree_insert(mymemory_t *memory, allocation_t *block)
+{
+    struct mymemory_size_node *right = size_insert_into(memory, memory->size_root, block);
+    if (right) // A raiz foi dividida: a árvore ganha um nível
+    {
+        struct mymemory_size_node *root = size_node_acquire(memory, 0);
+        root->count = 2;
+        root->item[0] = memory->size_root;
+        root->size[1] = right->size[0];
+        root->start[1] = right->start[0];
+        root->item[1] = right;
+        memory->size_root = root;
+    }
+}
+
+// Refaz a ocupação mínima do filho "i" de um nó interno pegando uma posição de um irmão ou juntando-o a ele
+static void size_fix_child(mymemory_t *memory, struct mymemory_size_node *node, uint32_t i)
+{
+    struct mymemory_size_node *child = (struct mymemory_size_node *)node->item[i];
+    struct mymemory_size_node *left = i > 0 ? (struct mymemory_size_node *)node->item[i - 1] : NULL;
+    struct mymemory_size_node *right = i + 1 < node->count ? (struct mymemory_size_node *)node->item[i + 1] : NULL;
+
+    if (left && left->count > SIZE_MIN_FILL) // Pega a última posição do irmão esquerdo
+    {
+        size_node_shift(child, 0);
+        size_node_copy(child, 0, left, left->count - 1, 1);
+        if (!child->leaf) // O filho que mudou de nó tinha como limite o separador do pai
+        {
+            child->size[1] = node->size[i];
+            child->start[1] = node->start[i];
+        }
+        left->count--;
+        node->size[i] = child->size[0];  // Novo limite inferior do filho
+        node->start[i] = child->start[0];
+        return;
+    }
+    if (right && right->count > SIZE_MIN_FILL) // Pega a primeira posição do irmão direito
+    {
+        size_node_copy(child, child->count, right, 0, 1);
+        if (!child->leaf)
+        {
+            child->size[child->count] = node->size[i + 1];
+            child->start[child->count] = node->start[i + 1];
+        }
+        child->count++;
+        size_node_erase(right, 0);
+        node->size[i + 1] = right->size[0];  // Em nós internos, o limite do novo primeiro filho do irmão
+        node->start[i + 1] = right->start[0];
+        return;
+    }
+
+    if (!left) // Junta sempre o da direita no da esquerda
+    {
+        left = child;
+        child = right;
+        i++;
+    }
+    if (!left->leaf) // O primeiro filho do nó absorvido recebe o separador do pai como limite
+    {
+        child->size[0] = node->size[i];
+        child->start[0] = node->start[i];
+    }
+    size_node_copy(left, left->count, child, 0, child->count);
+    left->count += child->count;
+    if (left->leaf)
+    {
+        left->next = child->next;
+        if (child->next)
+        {
+            child->next->prev = left;
+        }
+    }
+    size_node_erase(node, i);
+    size_node_release(memory, child);
+}
+
+// Remove a chave de uma subárvore; retorna 1 se o nó ficou abaixo da ocupação mínima
+static int size_remove_from(mymemory_t *memory, struct mymemory_size_node *node, size_t size, const char *start)
+{
+    if (node->leaf)
+    {
+        for (uint32_t i = 0; i < node->count; i++)
+        {
+            if (node->size[i] == size && node->start[i] == start)
+            {
+                size_node_erase(node, i);
+                break;
+            }
+        }
+        return node->count < SIZE_MIN_FILL;
+    }
+    uint32_t i = size_child_index(node, size, start);
+    if (size_remove_from(memory, (struct mymemory_size_node *)node->item[i], size, start))
+    {
+        size_fix_child(memory, node, i);
+    }
+    return node->count < SIZE_MIN_FILL;
+}
+
+// Retira da árvore a chave (size, start): o tamanho e o endereço que o bloco tinha ao entrar
+static void size_tree_remove(mymemory_t *memory, size_t size, const char *start)
+{
+    size_remove_from(memory, memory->size_root, size, start);
+    struct mymemory_size_node *root = memory->size_root;
+    if (!root->leaf && root->count == 1) // A raiz ficou com um filho só: a árvore perde um nível
+    {
+        memory->size_root = (struct mymemory_size_node *)root->item[0];
+        size_node_release(memory, root);
+    }
+}
+
+// Folha e posição da primeira chave >= (size, start); a posição pode ser igual a count (passa para a folha seguinte)
+static struct mymemory_size_node *size_lower_bound(mymemory_t *memory, size_t size, const char *start, uint32_t *position)
+{
+    struct mymemory_size_node *node = memory->size_root;
+    while (!node->leaf)
+    {
+        node = (struct mymemory_size_node *)node->item[size_child_index(node, size, start)];
+    }
+    uint32_t i = 0;
+    while (i < node->count && size_key_compare(size, start, node, i) > 0)
+    {
+        i++;
+    }
+    *position = i;
+    return node;
+}
+
+// Troca a chave (old_size, old_start) pela do bloco, que passou a ocupá-la (pode ser outro descritor, após uma fusão)
+// Se a nova chave continua entre as vizinhas da mesma folha, só a posição é reescrita; senão, remove e insere
+static void size_tree_update(mymemory_t *memory, size_t old_size, const char *old_start, allocation_t *block)
+{
+    uint32_t i;
+    struct mymemory_size_node *leaf = size_lower_bound(memory, old_size, old_start, &i);
+    size_t size = block->size;
+    char *start = (char *)block->start;
+
+    if (i < leaf->count && (i > 0 ? size_key_compare(size, start, leaf, i - 1) > 0 : !leaf->prev) &&
+        (i + 1 < leaf->count ? size_key_compare(size, start, leaf, i + 1) < 0 : !leaf->next))
+    {
+        leaf->size[i] = size;  // Primeira e última folha não têm limite à esquerda e à direita
+        leaf->start[i] = start;
+        leaf->item[i] = block;
+        return;
+    }
+    size_tree_remove(memory, old_size, old_start);
+    size_tree_insert(memory, block);
+}
+
+// Primeira chave a partir de (size, start) em que cabe um bloco de "size" bytes alinhado a "alignment"
+// Como as chaves crescem por tamanho e depois por endereço, é o menor bloco adequado e, entre iguais, o de menor endereço
+static allocation_t *size_first_fit_from(mymemory_t *memory, size_t key_size, size_t size, size_t alignment)
+{
+    uint32_t i;
+    struct mymemory_size_node *leaf = size_lower_bound(memory, key_size, NULL, &i);
+
+    for (; leaf; leaf = leaf->next, i = 0)
+    {
+        for (; i < leaf->count; i++)
+        {
+            size_t pad = (size_t)(-(uintptr_t)leaf->start[i]) & (alignment - 1);  // Preenchimento sem tocar no descritor
+            if (leaf->size[i] >= pad + size)
+            {
+                return (allocation_t *)leaf->item[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+// Best Fit em O(log n): o menor bloco livre que comporta o pedido
+static allocation_t *size_tree_best(mymemory_t *memory, size_t size, size_t alignment)
+{
+    return size_first_fit_from(memory, size, size, alignment);
+}
+
+// Worst Fit em O(log n): o maior bloco livre que comporta o pedido e, entre os de mesmo tamanho, o de menor endereço
+static allocation_t *size_tree_worst(mymemory_t *memory, size_t size, size_t alignment)
+{
+    struct mymemory_size_node *leaf = memory->size_root;
+    while (!leaf->leaf) // Última folha: chaves maiores
+    {
+        leaf = (struct mymemory_size_node *)leaf->item[leaf->count - 1];
+    }
+    for (; leaf; leaf = leaf->prev)
+    {
+        for (uint32_t i = leaf->count; i-- > 0;)
+        {
+            if (leaf->size[i] < size)
+            {
+                return NULL;  // Daqui para trás todos são menores que o pedido
+            }
+            size_t pad = (size_t)(-(uintptr_t)leaf->start[i]) & (alignment - 1);
+            if (leaf->size[i] >= pad + size)
+            {
+                return size_first_fit_from(memory, leaf->size[i], size, alignment);  // Primeiro adequado desse tamanho
+            }
+        }
+    }
+    return NULL;
+}
+
+// Maior bloco livre da árvore (0 se vazia)
+static size_t size_tree_largest(mymemory_t *memory)
+{
+    struct mymemory_size_node *node = memory->size_root;
+    while (!node->leaf)
+    {
+        node = (struct mymemory_size_node *)node->item[node->count - 1];
+    }
+    for (; node; node = node->prev) // A última folha só fica vazia se a árvore toda estiver
+    {
+        if (node->count)
+        {
+            return node->size[node->count - 1];
+        }
+    }
+    return 0;
+}
+
+// Um bloco livre entrou na lista ordenada por endereços (First, Best e Worst Fit): contadores e árvore por tamanho
+static void free_block_added(mymemory_t *memory, allocation_t *block)
+{
+    stats_free_added(memory, block->size);
+    if (memory->size_root)
+    {
+        size_tree_insert(memory, block);
+    }
+}
+
+// O bloco livre de chave (size, start) saiu da lista ordenada por endereços
+static void free_key_removed(mymemory_t *memory, size_t size, const char *start)
+{
+    stats_free_removed(memory, size);
+    if (memory->size_root)
+    {
+        size_tree_remove(memory, size, start);
+    }
+}
+
+// Um bloco livre saiu da lista ordenada por endereços; chamado antes de o bloco mudar de tamanho ou de início
+static void free_block_removed(mymemory_t *memory, allocation_t *block)
+{
+    free_key_removed(memory, block->size, (char *)block->start);
+}
+
+// Um bloco livre que tinha a chave (old_size, old_start) mudou de tamanho ou de início sem sair do lugar na lista
+static void free_block_changed(mymemory_t *memory, allocation_t *block, size_t old_size, const char *old_start)
+{
+    stats_free_removed(memory, old_size);
+    stats_free_added(memory, block->size);
+    if (memory->size_root)
+    {
+        size_tree_update(memory, old_size, old_start, block);
+    }
+}
+
+// Deixa o pool com um único bloco livre cobrindo tudo (estratégias com descritores)
+static void reset_blocks(mymemory_t *memory)
+{
+    for (allocation_t *block = memory->allocated_blocks; block; block = block->next) // Limpa só as posições usadas do índice
+    {
+        memory->index_slots[index_slot(memory, block->start)] = NULL;
+    }
+    memory->index_count = 0; // Nenhum bloco registrado
+    memory->descriptors_used = 0; // Todo o slab volta a estar disponível
+    memory->free_descriptors = NULL;
+    memory->quarantine_head = 0; // Os blocos da quarentena deixam de existir
+    memory->quarantine_count = 0;
+    memory->fl_bitmap = 0; // Listas segregadas vazias
+    memset(memory->sl_bitmap, 0, sizeof(memory->sl_bitmap));
+    memset(memory->segregated, 0, sizeof(memory->segregated));
+    stats_reset(memory);
+    if (memory->size_nodes)
+    {
+        size_tree_reset(memory);  // Árvore por tamanho vazia
+    }
+
+    allocation_t *initial = descriptor_acquire(memory); // Bloco livre inicial que cobre todo o pool
+    initial->start = memory->pool; // Define o início do bloco livre como o início do pool
+    initial->size = memory->total_size; // Define o tamanho do bloco livre
+    initial->next = NULL; // Não há blocos livres adicionais, então o próximo é NULL
+    initial->prev = NULL;
+    initial->phys_prev = NULL; // Único bloco do pool
+    initial->phys_next = NULL;
+    initial->is_free = 1;
+    initial->owner = 0;
+    memory->head = initial; // Início do encadeamento físico
+    memory->free_blocks = NULL; // Lista de livres (estratégias First, Best e Worst Fit)
+    memory->allocated_blocks = NULL; // Inicialmente, não há blocos alocados
+    if (memory->strategy == SEGREGATED_FIT)
+    {
+        segregated_insert(memory, initial); // O bloco inicial entra na lista da sua classe
+    }
+    else
+    {
+        memory->free_blocks = initial; // O bloco inicial é a lista de livres
+        free_block_added(memory, initial);
+    }
+}
+
+// Indica se a estratégia guarda cada bloco em um descritor (listas, índice e encadeamento físico)
+static int uses_descriptors(mymemory_t *memory)
+{
+    return memory->strategy != ARENA && memory->strategy != SLAB && memory->strategy != BUDDY;
+}
+
+// Nome da estratégia de alocação, para mensagens
+static const char *strategy_name(AllocationStrategy strategy)
+{
+    switch (strategy)
+    {
+        case FIRST_FIT: return "First Fit";
+        case BEST_FIT: return "Best Fit";
+        case WORST_FIT: return "Worst Fit";
+        case SEGREGATED_FIT: return "Segregated Fit";
+        case ARENA: return "Arena";
+        case SLAB: return "Slab";
+        case BUDDY: return "Buddy";
+    }
+    return "?";
+}
+
+// Estrutura para o pool de memória
+mymemory_t* mymemory_init(size_t size, AllocationStrategy strategy)
+{
+    mymemory_config_t config = { 0 }; // Configuração padrão: alinhamento de 16 bytes, uma thread
+    config.verbose = 1; // O programa interativo mostra as mensagens de liberação
+    return mymemory_init_config(size, strategy, &config);
+}
+
+// Pool crescente: reserva a faixa de endereços de "config->max_size" bytes e habilita as regiões dos primeiros "size" bytes
+// As regiões são fatias de uma única reserva, então deslocamentos, índice e encadeamento físico continuam contíguos
+static int regions_map(mymemory_t *memory, size_t size, size_t alignment, const mymemory_config_t *config)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t region = config->region_size ? config->region_size : MYMEMORY_REGION_SIZE;
+    size_t unit = alignment > page ? alignment : page;  // Toda região começa em página e no alinhamento do pool
+
+    if (config->huge_pages && unit < MYMEMORY_REGION_SIZE)
+    {
+        unit = MYMEMORY_REGION_SIZE;  // Regiões em páginas grandes inteiras
+    }
+    region = (region + unit - 1) / unit * unit;
+    size = ((size ? size : 1) + region - 1) / region * region;
+    size_t max_size = (config->max_size + region - 1) / region * region;
+    size_t extra = alignment > page ? alignment : 0;  // Folga para alinhar o início da reserva
+
+    char *base = MAP_FAILED;
+    if (config->huge_pages) // Páginas grandes reservadas pelo sistema; sem elas, cai no mapeamento comum
+    {
+        base = mmap(NULL, max_size + extra, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        memory->region_hugetlb = base != MAP_FAILED;
+    }
+    if (base == MAP_FAILED)
+    {
+        base = mmap(NULL, max_size + extra, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    }
+    if (base == MAP_FAILED)
+    {
+        return 0;
+    }
+    char *pool = extra ? (char *)(((uintptr_t)base + alignment - 1) & ~(uintptr_t)(alignment - 1)) : base;
+    if (pool > base)
+    {
+        munmap(base, (size_t)(pool - base));  // Sobra antes do início alinhado
+    }
+    if (extra && (size_t)(pool - base) < extra)
+    {
+        munmap(pool + max_size, extra - (size_t)(pool - base));  // Sobra depois do fim
+    }
+    if (config->huge_pages && !memory->region_hugetlb)
+    {
+        madvise(pool, max_size, MADV_HUGEPAGE);  // Pede páginas grandes transparentes
+    }
+    if (mprotect(pool, size, PROT_READ | PROT_WRITE) != 0)
+    {
+        munmap(pool, max_size);
+        return 0;
+    }
+
+    memory->pool = pool;
+    memory->total_size = size;
+    memory->max_size = max_size;
+    memory->region_size = region;
+    memory->region_resident = (uint64_t *)calloc((max_size / region + 63) / 64, sizeof(uint64_t));  // Nenhuma região tocada ainda
+    return memory->region_resident != NULL;  // Sem o mapa, mymemory_cleanup devolve a reserva
+}
+
+// Pool crescente: reserva "bytes" de endereços para uma tabela, sem memória por trás (tables_commit habilita o começo dela)
+static void *table_reserve(size_t bytes)
+{
+    void *table = mmap(NULL, bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return table == MAP_FAILED ? NULL : table;
+}
+
+// Habilita os primeiros "used" bytes (em páginas inteiras) de uma tabela reservada com "reserved" bytes
+static int table_commit(void *table, size_t used, size_t reserved)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    used = (used < reserved ? used : reserved) + page - 1;
+    return mprotect(table, used / page * page, PROT_READ | PROT_WRITE) == 0;
+}
+
+// Pool crescente: habilita as partes de descritores, índice e árvore por tamanho que um pool de "size" bytes pode usar
+// Cada tabela é reservada para max_size e acompanha o pool; retorna 0 se o sistema recusar
+static int tables_commit(mymemory_t *memory, size_t size)
+{
+    size_t capacity = size / memory->alignment + 1;  // Mesmo limite do pool_setup, para o tamanho atual
+    if (memory->descriptors && (!table_commit(memory->descriptors, capacity * sizeof(allocation_t), memory->descriptor_capacity * sizeof(allocation_t)) ||
+                                !table_commit(memory->index_slots, capacity * sizeof(allocation_t *), memory->index_capacity * sizeof(allocation_t *))))
+    {
+        return 0;
+    }
+    if (memory->size_nodes && !table_commit(memory->size_nodes, size_tree_capacity(capacity) * sizeof(struct mymemory_size_node),
+                                            memory->size_node_capacity * sizeof(struct mymemory_size_node)))
+    {
+        return 0;
+    }
+    return 1;
+}
+
+// Prepara as estruturas da estratégia escolhida para um pool vazio
+// Tabelas que já apontam para algum lugar (pool persistente) são usadas no lugar; as demais são alocadas aqui
+// Retorna 0 se faltar memória para alguma tabela (quem chama desiste do pool)
+static int pool_setup(mymemory_t *memory)
+{
+    if (memory->strategy == ARENA) // A arena não tem descritores: só o topo
+    {
+        memory->arena_top = 0; // Nada alocado
+        memory->arena_last = SIZE_MAX; // Nenhum objeto alocado ainda
+        memory->arena_count = 0;
+        memory->arena_dirty = 0; // Bitmap novo: nenhuma marca antiga
+        if (!memory->arena_starts)
+        {
+            memory->arena_starts = (uint64_t *)calloc((memory->max_size >> memory->alignment_shift) / 64 + 1, sizeof(uint64_t)); // Nenhum objeto
+        }
+        return memory->arena_starts != NULL;
+    }
+    if (memory->strategy == SLAB) // O Slab usa uma tabela de páginas em vez de descritores
+    {
+        return slab_init(memory);
+    }
+    if (memory->strategy == BUDDY) // O Buddy usa bitmaps por ordem e listas dentro dos próprios blocos livres
+    {
+        return buddy_init(memory);
+    }
+
+    // Todo bloco tem pelo menos "alignment" bytes, então o pool nunca tem mais que max_size / alignment + 1 blocos.
+    // Descritores e índice são reservados aqui de uma vez; as páginas só são tocadas conforme os blocos são criados.
+    // No pool crescente só a faixa de endereços é reservada: tables_commit habilita o que o tamanho atual pode usar.
+    memory->descriptor_capacity = memory->max_size / memory->alignment + 1; // Máximo de blocos simultâneos
+    memory->index_capacity = memory->descriptor_capacity; // Um slot do índice por unidade de alocação
+    if (!memory->descriptors && memory->region_size)
+    {
+        memory->descriptors = (allocation_t *)table_reserve(memory->descriptor_capacity * sizeof(allocation_t)); // Slab de descritores
+        memory->index_slots = (allocation_t **)table_reserve(memory->index_capacity * sizeof(allocation_t *)); // Índice vazio (páginas novas vêm zeradas)
+        if (!memory->descriptors || !memory->index_slots || !tables_commit(memory, memory->total_size))
+        {
+            return 0;
+        }
+    }
+    else if (!memory->descriptors)
+    {
+        memory->descriptors = (allocation_t*)malloc(memory->descriptor_capacity * sizeof(allocation_t)); // Slab de descritores
+        memory->index_slots = (allocation_t **)calloc(memory->index_capacity, sizeof(allocation_t *)); // Índice vazio
+        if (!memory->descriptors || !memory->index_slots)
+        {
+            return 0;
+        }
+    }
+    if ((memory->strategy == BEST_FIT || memory->strategy == WORST_FIT) && !memory->size_nodes && !size_tree_init(memory)) // Árvore por tamanho: fora do arquivo no pool persistente, refeita a cada abertura
+    {
+        return 0;
+    }
+    reset_blocks(memory); // Um único bloco livre cobrindo todo o pool
+    return 1;
+}
+
+// Inicializa o pool com uma configuração explícita (alinhamento mínimo dos blocos)
+mymemory_t* mymemory_init_config(size_t size, AllocationStrategy strategy, const mymemory_config_t *config)
+{
+    size_t alignment = config && config->alignment ? config->alignment : MYMEMORY_GRANULE; // Alinhamento pedido
+
+    if (alignment & (alignment - 1)) // O alinhamento precisa ser potência de 2
+    {
+        return NULL;
+    }
+    if (alignment < MYMEMORY_GRANULE)
+    {
+        alignment = MYMEMORY_GRANULE; // Nunca abaixo do alinhamento mínimo
+    }
+
+    mymemory_t *memory = (mymemory_t*)calloc(1, sizeof(mymemory_t)); // Aloca a estrutura de controle principal de memória (bitmaps e listas zerados)
+    if (!memory)
+    {
+        return NULL;
+    }
+    size_t pool_alignment = ((strategy == SLAB || strategy == BUDDY) && alignment < MYMEMORY_SLAB_PAGE) ? MYMEMORY_SLAB_PAGE : alignment; // Slab e Buddy: páginas alinhadas
+    if (config && config->max_size > size && strategy != SLAB && strategy != BUDDY) // Pool crescente: regiões mapeadas sob demanda
+    {
+        if (!regions_map(memory, size, alignment, config))
+        {
+            if (memory->region_size) // Só o mapa de regiões faltou: a reserva já existe
+            {
+                mymemory_cleanup(memory);
+                return NULL;
+            }
+            free(memory);
+            return NULL;
+        }
+        size = memory->total_size; // Arredondado para regiões inteiras
+    }
+    else if (posix_memalign(&memory->pool, pool_alignment, size ? size : alignment) != 0) // Aloca o pool de memória total, já alinhado
+    {
+        free(memory);
+        return NULL;
+    }
+    memory->total_size = size; // Define o tamanho total do pool de memória
+    memory->compact_cursor = SIZE_MAX; // A compactação começa do início do pool
+    if (!memory->region_size)
+    {
+        memory->max_size = size; // Pool fixo: nunca cresce
+    }
+    memory->alignment = alignment; // Unidade de alocação do pool
+    memory->alignment_shift = (unsigned)__builtin_ctzll((unsigned long long)alignment);
+
+    memory->strategy = strategy; // Define a estratégia de alocação (First Fit, Best Fit, Worst Fit, Segregated Fit, Arena)
+    memory->verbose = config ? config->verbose : 0; // Mensagens nas operações
+    memory->concurrent = config && (config->concurrent || (config->deferred_free && strategy != ARENA)); // Uso por várias threads (as liberações adiadas também exigem)
+    memory->harden = config && config->harden && uses_descriptors(memory); // Modo de depuração
+    if (memory->harden)
+    {
+        memory->quarantine = (allocation_t **)malloc(MYMEMORY_QUARANTINE * sizeof(allocation_t *)); // Fila da quarentena
+        if (!memory->quarantine)
+        {
+            mymemory_cleanup(memory);
+            return NULL;
+        }
+    }
+    if (memory->concurrent)
+    {
+        if (pthread_mutex_init(&memory->lock, NULL) != 0) // Protege as listas, o índice e o slab de descritores
+        {
+            memory->concurrent = 0;  // Nada para mymemory_cleanup destruir
+            mymemory_cleanup(memory);
+            return NULL;
+        }
+        if (posix_memalign((void **)&memory->thread_caches, 64, MYMEMORY_MAX_THREADS * sizeof(*memory->thread_caches)) != 0) // Um cache por slot de thread
+        {
+            memory->thread_caches = NULL;
+            mymemory_cleanup(memory);
+            return NULL;
+        }
+        memset(memory->thread_caches, 0, MYMEMORY_MAX_THREADS * sizeof(*memory->thread_caches));
+    }
+#ifdef MYMEMORY_INSTRUMENT
+    if (posix_memalign((void **)&memory->instrument, 64, MYMEMORY_MAX_THREADS * sizeof(*memory->instrument)) != 0) // Contadores por slot de thread
+    {
+        memory->instrument = NULL;
+        mymemory_cleanup(memory);
+        return NULL;
+    }
+    memset(memory->instrument, 0, MYMEMORY_MAX_THREADS * sizeof(*memory->instrument));
+#endif
+
+    if (!pool_setup(memory)) // Estruturas da estratégia para o pool vazio
+    {
+        mymemory_cleanup(memory);
+        return NULL;
+    }
+    if (config && config->deferred_free && strategy != ARENA && !defer_start(memory)) // Liberações adiadas: filas por slot e thread de manutenção
+    {
+        mymemory_cleanup(memory);
+        return NULL;
+    }
+    return memory; // Retorna o ponteiro para a estrutura de controle de memória
+}
+
+// Registra um bloco como alocado: lista de alocados e índice
+static void register_allocated(mymemory_t *memory, allocation_t *block)
+{
+    block->is_free = 0;  // Marca o bloco como alocado
+    block->handle = 0;  // Bloco comum até que mymemory_halloc o associe a um handle
+    block->quarantined = 0;
+    block->cached = 0;
+    block->next = memory->allocated_blocks;  // Insere o bloco na lista de alocados
+    block->prev = NULL;  // Passa a ser o primeiro da lista
+    if (memory->allocated_blocks)
+    {
+        memory->allocated_blocks->prev = block;  // Antigo primeiro aponta para o novo
+    }
+    memory->allocated_blocks = block;  // Atualiza o início da lista de alocados
+    index_insert(memory, block);  // Registra o bloco no índice
+    memory->counters.allocated_blocks++;
+    stats_in_use_add(memory, block->size);
+}
+
+// Separa os primeiros "size" bytes de um bloco em um novo bloco, que fica fisicamente antes dele
+// O bloco original passa a representar apenas o restante
+static allocation_t *split_front(mymemory_t *memory, allocation_t *block, size_t size)
+{
+    allocation_t *front = descriptor_acquire(memory);  // Cria nova entrada para a parte da frente
+    front->start = block->start;  // A parte da frente começa onde o bloco começava
+    front->owner = 0;  // Ainda não pertence a nenhum cache de thread
+    front->size = size;
+    front->phys_prev = block->phys_prev;  // Insere a parte da frente no encadeamento físico
+    front->phys_next = block;
+    if (block->phys_prev)
+    {
+        block->phys_prev->phys_next = front;
+    }
+    else
+    {
+        memory->head = front;  // A parte da frente passa a ser o primeiro bloco do pool
+    }
+    block->phys_prev = front;
+    block->start = (char*)block->start + size;  // Atualiza o início do bloco restante
+    block->size -= size;  // Ajusta o tamanho do bloco restante
+    return front;
+}
+
+// Funde no bloco o seu vizinho físico seguinte, que já deve ter saído de qualquer lista
+static void absorb_next(mymemory_t *memory, allocation_t *block)
+{
+    allocation_t *next = block->phys_next;  // Bloco que será absorvido
+    block->size += next->size;  // Soma o tamanho do vizinho
+    block->phys_next = next->phys_next;  // Pula o vizinho no encadeamento físico
+    if (next->phys_next)
+    {
+        next->phys_next->phys_prev = block;
+    }
+    descriptor_release(memory, next);  // Devolve ao slab a entrada que deixou de existir
+}
+
+// Retira um bloco da lista de livres ordenada por endereços (First, Best e Worst Fit)
+static void free_list_unlink(mymemory_t *memory, allocation_t *block)
+{
+    if (block->prev)
+    {
+        block->prev->next = block->next;
+    }
+    else
+    {
+        memory->free_blocks = block->next;  // Era o primeiro da lista
+    }
+    if (block->next)
+    {
+        block->next->prev = block->prev;
+    }
+}
+
+// Retira um pedaço de "size" bytes de um bloco livre, "pad" bytes depois do seu início, e o registra como alocado
+// A lista de livres é mantida em ordem de endereços: o preenchimento e o restante continuam livres, na mesma posição
+static void *carve_free_block(mymemory_t *memory, allocation_t *block, size_t size, size_t pad)
+{
+    allocation_t *allocated;  // Entrada do bloco alocado
+    size_t old_size = block->size;  // Chave do bloco antes das divisões (árvore por tamanho)
+    char *old_start = (char *)block->start;
+
+    if (pad) // O preenchimento antes do endereço alinhado vira um bloco livre próprio
+    {
+        allocation_t *padding = split_front(memory, block, pad);
+        padding->is_free = 1;
+        padding->prev = block->prev;  // Fica logo antes do bloco na lista (endereço menor)
+        padding->next = block;
+        if (block->prev)
+        {
+            block->prev->next = padding;
+        }
+        else
+        {
+            memory->free_blocks = padding;
+        }
+        block->prev = padding;
+        free_block_added(memory, padding);
+    }
+
+    if (block->size > size) // Se o bloco livre é maior que o necessário
+    {  
+        allocated = split_front(memory, block, size);  // O restante continua na mesma posição da lista
+        free_block_changed(memory, block, old_size, old_start);
+    } 
+    else 
+    {
+        free_key_removed(memory, old_size, old_start);
+        free_list_unlink(memory, block);  // Remove o bloco da lista de livres
+        allocated = block;  // Reaproveita a entrada se o tamanho for exatamente o necessário
+    }
+    register_allocated(memory, allocated);
+    return allocated->start;  // Retorna o endereço do início do bloco alocado
+}
+
+// Bytes que faltam a partir do início do bloco até o próximo endereço com o alinhamento pedido
+static size_t alignment_padding(allocation_t *block, size_t alignment)
+{
+    return (size_t)(-(uintptr_t)block->start) & (alignment - 1);
+}
+
+// Calcula a classe (primeiro nível) e subclasse (segundo nível) de um tamanho
+static void segregated_mapping(size_t size, int *fl, int *sl)
+{
+    if (size < MYMEMORY_SL_COUNT) // Tamanhos pequenos: uma subclasse por byte na classe 0
+    {
+        *fl = 0;
+        *sl = (int)size;
+    }
+    else
+    {
+        int msb = 63 - __builtin_clzll((unsigned long long)size);  // Posição do bit mais significativo
+        *fl = msb - MYMEMORY_SL_LOG2 + 1;  // Uma classe por potência de 2
+        *sl = (int)(size >> (msb - MYMEMORY_SL_LOG2)) & (MYMEMORY_SL_COUNT - 1);  // Bits logo abaixo do mais significativo
+    }
+}
+
+// Insere um bloco livre no início da lista da sua classe e liga os bits correspondentes
+static void segregated_insert(mymemory_t *memory, allocation_t *block)
+{
+    int fl, sl;
+    segregated_mapping(block->size, &fl, &sl);
+
+    block->is_free = 1;
+    block->prev = NULL;
+    block->next = memory->segregated[fl][sl];
+    if (block->next)
+    {
+        block->next->prev = block;
+    }
+    memory->segregated[fl][sl] = block;
+    memory->fl_bitmap |= 1ULL << fl;  // A classe tem pelo menos uma lista não vazia
+    memory->sl_bitmap[fl] |= 1U << sl;  // A subclasse não está vazia
+    stats_free_added(memory, block->size);
+}
+
+// Remove um bloco livre da lista da sua classe, desligando os bits se ela ficar vazia
+static void segregated_remove(mymemory_t *memory, allocation_t *block)
+{
+    int fl, sl;
+    segregated_mapping(block->size, &fl, &sl);
+
+    if (block->prev)
+    {
+        block->prev->next = block->next;
+    }
+    else
+    {
+        memory->segregated[fl][sl] = block->next;
+    }
+    if (block->next)
+    {
+        block->next->prev = block->prev;
+    }
+    if (!memory->segregated[fl][sl]) // A lista ficou vazia
+    {
+        memory->sl_bitmap[fl] &= ~(1U << sl);
+        if (!memory->sl_bitmap[fl])
+        {
+            memory->fl_bitmap &= ~(1ULL << fl);
+        }
+    }
+    stats_free_removed(memory, block->size);
+}
+
+// Procura, em O(1), um bloco livre de uma classe cujos blocos tenham todos pelo menos "size" bytes
+static allocation_t *segregated_find(mymemory_t *memory, size_t size)
+{
+    int fl, sl;
+
+    if (size >= MYMEMORY_SL_COUNT) // Arredonda para o início da próxima subclasse (todo bloco dela serve)
+    {
+        int msb = 63 - __builtin_clzll((unsigned long long)size);
+        size_t round = ((size_t)1 << (msb - MYMEMORY_SL_LOG2)) - 1;
+        if (size > SIZE_MAX - round)
+        {
+            return NULL;
+        }
+        size += round;
+    }
+    segregated_mapping(size, &fl, &sl);
+
+    uint32_t sl_map = memory->sl_bitmap[fl] & (~0U << sl);  // Subclasses suficientes na mesma classe
+    if (!sl_map)
+    {
+        if (fl + 1 >= MYMEMORY_FL_COUNT)
+        {
+            return NULL;
+        }
+        uint64_t fl_map = memory->fl_bitmap & (~0ULL << (fl + 1));  // Classes maiores com blocos livres
+        if (!fl_map)
+        {
+            return NULL;  // Nenhum bloco grande o suficiente
+        }
+        fl = __builtin_ctzll(fl_map);
+        sl_map = memory->sl_bitmap[fl];
+    }
+    sl = __builtin_ctz(sl_map);
+    return memory->segregated[fl][sl];
+}
+
+// Alocação com listas segregadas (Segregated Fit / TLSF)
+static void *segregated_alloc(mymemory_t *memory, size_t size, size_t alignment)
+{
+    size_t slack = alignment - memory->alignment;  // Pior caso de preenchimento para alinhar o início
+    allocation_t *block = segregated_find(memory, size + slack);  // Bloco de uma classe adequada
+    allocation_t *allocated;  // Entrada do bloco alocado
+    INSTRUMENT_DECLARE(steps);  // Blocos examinados na última tentativa
+
+    if (!block) // Última tentativa: a própria subclasse do tamanho pode ter um bloco grande o suficiente
+    {
+        int fl, sl;
+        segregated_mapping(size + slack, &fl, &sl);
+        for (block = memory->segregated[fl][sl]; block && block->size < alignment_padding(block, alignment) + size; block = block->next)
+        {
+            INSTRUMENT_STEP(steps);
+        }
+    }
+    INSTRUMENT_SEARCH(memory, 0, steps);
+    if (!block)
+    {
+        return NULL;  // Retorna NULL se nenhum bloco adequado foi encontrado
+    }
+    segregated_remove(memory, block);
+
+    size_t pad = alignment_padding(block, alignment);
+    if (pad) // O preenchimento antes do endereço alinhado volta para as listas como bloco livre
+    {
+        segregated_insert(memory, split_front(memory, block, pad));
+    }
+    if (block->size > size) // Sobra espaço: o restante volta para a lista da sua classe
+    {
+        allocated = split_front(memory, block, size);
+        segregated_insert(memory, block);
+    }
+    else
+    {
+        allocated = block;
+    }
+    register_allocated(memory, allocated);
+    return allocated->start;
+}
+
+// Devolve um bloco às listas segregadas, fundindo com os vizinhos físicos livres em O(1)
+// Retorna o bloco livre que passou a conter o bloco devolvido
+static allocation_t *segregated_free(mymemory_t *memory, allocation_t *block)
+{
+    if (block->phys_next && block->phys_next->is_free) // Vizinho seguinte livre
+    {
+        segregated_remove(memory, block->phys_next);
+        absorb_next(memory, block);
+    }
+    if (block->phys_prev && block->phys_prev->is_free) // Vizinho anterior livre
+    {
+        allocation_t *prev = block->phys_prev;
+        segregated_remove(memory, prev);
+        absorb_next(memory, prev);  // O anterior absorve o bloco liberado
+        block = prev;
+    }
+    segregated_insert(memory, block);
+    return block;
+}
+
+// Na arena tudo abaixo do topo está em uso: o pico acompanha o topo
+static void arena_track_peak(mymemory_t *memory)
+{
+    if (memory->arena_top > memory->counters.peak_bytes_in_use)
+    {
+        memory->counters.peak_bytes_in_use = memory->arena_top;
+    }
+}
+
+// Arena: marca o início de um objeto no deslocamento "offset"
+static void arena_mark_start(mymemory_t *memory, size_t offset)
+{
+    size_t unit = offset >> memory->alignment_shift;
+    memory->arena_starts[unit / 64] |= 1ULL << (unit % 64);
+}
+
+// Arena: 1 se um objeto começa no deslocamento "offset" (abaixo do topo)
+static int arena_is_start(mymemory_t *memory, size_t offset)
+{
+    if (offset & (memory->alignment - 1))
+    {
+        return 0;  // Dentro da primeira unidade de um objeto, não no seu início
+    }
+    size_t unit = offset >> memory->alignment_shift;
+    return (int)((memory->arena_starts[unit / 64] >> (unit % 64)) & 1);
+}
+
+// Arena: apaga as marcas de início dos objetos em [from, to)
+static void arena_clear_starts(mymemory_t *memory, size_t from, size_t to)
+{
+    size_t unit = from >> memory->alignment_shift;
+    size_t end = (to + memory->alignment - 1) >> memory->alignment_shift;
+    while (unit < end)
+    {
+        if (unit % 64 == 0 && end - unit >= 64) // Palavra inteira
+        {
+            memory->arena_starts[unit / 64] = 0;
+            unit += 64;
+            continue;
+        }
+        memory->arena_starts[unit / 64] &= ~(1ULL << (unit % 64));
+        unit++;
+    }
+}
+
+// Arena: sobe (ou desce) o topo para "top"
+// Rollback, reset e objetos desfeitos só descem o topo e deixam as marcas acima dele; elas são apagadas aqui,
+// quando o topo volta a passar por elas, e só no trecho que já tinha sido usado (o custo vai para quem aloca)
+static void arena_set_top(mymemory_t *memory, size_t top)
+{
+    if (memory->arena_top < memory->arena_dirty)
+    {
+        arena_clear_starts(memory, memory->arena_top, top < memory->arena_dirty ? top : memory->arena_dirty);
+    }
+    if (top > memory->arena_dirty)
+    {
+        memory->arena_dirty = top;
+    }
+    memory->arena_top = top;
+}
+
+// Arena: bytes do objeto que começa em "offset", até o início do próximo objeto ou até o topo
+static size_t arena_object_size(mymemory_t *memory, size_t offset)
+{
+    size_t unit = (offset >> memory->alignment_shift) + 1;
+    size_t end = (memory->arena_top + memory->alignment - 1) >> memory->alignment_shift;
+    while (unit < end)
+    {
+        uint64_t word = memory->arena_starts[unit / 64] >> (unit % 64);
+        if (word)
+        {
+            unit += (size_t)__builtin_ctzll(word);
+            break;
+        }
+        unit = (unit | 63) + 1;  // Nenhum início no resto da palavra
+    }
+    size_t next = unit << memory->alignment_shift;
+    return (next < memory->arena_top ? next : memory->arena_top) - offset;
+}
+
+// Alocação por incremento de ponteiro (Arena): o objeto começa no primeiro endereço alinhado a partir do topo
+static void *arena_alloc(mymemory_t *memory, size_t size, size_t alignment)
+{
+    uintptr_t base = (uintptr_t)memory->pool;
+    size_t start = (size_t)(((base + memory->arena_top + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base);  // Deslocamento alinhado
+
+    if (start > memory->total_size || memory->total_size - start < size)
+    {
+        return NULL;  // A arena está cheia
+    }
+    memory->arena_last = start;  // Lembra o último objeto (pode crescer ou ser desfeito no lugar)
+    arena_set_top(memory, start + size);
+    arena_mark_start(memory, start);
+    memory->arena_count++;
+    arena_track_peak(memory);
+    return (char *)memory->pool + start;
+}
+
+// Menor classe cujos objetos comportam "size" bytes (potências de 2, então o objeto fica alinhado ao próprio tamanho)
+static int slab_class(size_t size)
+{
+    return size <= MYMEMORY_GRANULE ? 0 : (64 - __builtin_clzll((unsigned long long)(size - 1))) - 4;
+}
+
+// Prepara a tabela de páginas e o mapa de páginas livres; retorna 0 se faltar memória para as tabelas
+static int slab_init(mymemory_t *memory)
+{
+    memory->slab_page_count = memory->total_size / MYMEMORY_SLAB_PAGE;  // Um resto menor que uma página fica sem uso
+    if (!memory->slab_pages)
+    {
+        memory->slab_pages = (struct mymemory_slab_page *)malloc((memory->slab_page_count + 1) * sizeof(struct mymemory_slab_page));
+        memory->slab_free_map = (uint64_t *)malloc((memory->slab_page_count / 64 + 1) * sizeof(uint64_t));
+        if (!memory->slab_pages || !memory->slab_free_map)
+        {
+            return 0;
+        }
+    }
+    memset(memory->slab_pages, 0, memory->slab_page_count * sizeof(struct mymemory_slab_page));  // Todas livres
+    memset(memory->slab_free_map, 0, (memory->slab_page_count / 64 + 1) * sizeof(uint64_t));
+    for (size_t i = 0; i < memory->slab_page_count; i++)
+    {
+        memory->slab_free_map[i / 64] |= 1ULL << (i % 64);
+    }
+    for (int cls = 0; cls < MYMEMORY_SLAB_CLASSES; cls++)
+    {
+        memory->slab_partial[cls] = -1;  // Nenhuma página parcialmente ocupada
+    }
+    stats_reset(memory);
+    if (memory->slab_page_count)
+    {
+        stats_free_added(memory, memory->slab_page_count * MYMEMORY_SLAB_PAGE);  // Uma única sequência de páginas livres
+    }
+    if (memory->slab_runs)
+    {
+        slab_runs_build(memory);
+        return 1;
+    }
+    return slab_runs_init(memory);
+}
+
+// Indica se a página "index" está livre
+static int slab_page_is_free(mymemory_t *memory, size_t index)
+{
+    return (int)((memory->slab_free_map[index / 64] >> (index % 64)) & 1);
+}
+
+// Recalcula um nó da árvore de sequências livres a partir dos dois filhos, que cobrem "span" páginas cada
+static void slab_run_pull(struct mymemory_slab_run *runs, size_t node, uint32_t span)
+{
+    const struct mymemory_slab_run *left = &runs[2 * node], *right = &runs[2 * node + 1];
+    uint32_t across = left->suffix + right->prefix;  // Sequência que atravessa o meio
+
+    runs[node].prefix = left->prefix == span ? span + right->prefix : left->prefix;
+    runs[node].suffix = right->suffix == span ? span + left->suffix : right->suffix;
+    runs[node].best = left->best > right->best ? left->best : right->best;
+    if (across > runs[node].best)
+    {
+        runs[node].best = across;
+    }
+}
+
+// Atualiza as folhas das páginas [first, first + count) e, nível a nível, só os nós acima delas
+static void slab_runs_update(mymemory_t *memory, size_t first, size_t count, int free_pages)
+{
+    struct mymemory_slab_run *runs = memory->slab_runs;
+    uint32_t leaf = free_pages ? 1 : 0;
+
+    for (size_t i = first; i < first + count; i++)
+    {
+        runs[memory->slab_run_leaves + i] = (struct mymemory_slab_run){ leaf, leaf, leaf };
+    }
+    size_t low = (memory->slab_run_leaves + first) / 2, high = (memory->slab_run_leaves + first + count - 1) / 2;
+    for (uint32_t span = 1; low >= 1; span *= 2, low /= 2, high /= 2)
+    {
+        for (size_t node = low; node <= high; node++)
+        {
+            slab_run_pull(runs, node, span);
+        }
+    }
+}
+
+// Refaz a árvore inteira a partir do mapa de páginas (inicialização e abertura de pool persistente)
+static void slab_runs_build(mymemory_t *memory)
+{
+    struct mymemory_slab_run *runs = memory->slab_runs;
+
+    memset(runs, 0, 2 * memory->slab_run_leaves * sizeof(struct mymemory_slab_run));  // Folhas além do pool: páginas ocupadas
+    for (size_t i = 0; i < memory->slab_page_count; i++)
+    {
+        uint32_t leaf = (uint32_t)slab_page_is_free(memory, i);
+        runs[memory->slab_run_leaves + i] = (struct mymemory_slab_run){ leaf, leaf, leaf };
+    }
+    uint32_t span = 1;
+    for (size_t level = memory->slab_run_leaves / 2; level >= 1; level /= 2, span *= 2)
+    {
+        for (size_t node = level; node < 2 * level; node++)
+        {
+            slab_run_pull(runs, node, span);
+        }
+    }
+}
+
+// Reserva a árvore de sequências livres do Slab (fora do arquivo no pool persistente); 0 se faltar memória
+static int slab_runs_init(mymemory_t *memory)
+{
+    memory->slab_run_leaves = 1;
+    while (memory->slab_run_leaves < memory->slab_page_count)
+    {
+        memory->slab_run_leaves *= 2;
+    }
+    memory->slab_runs = (struct mymemory_slab_run *)malloc(2 * memory->slab_run_leaves * sizeof(struct mymemory_slab_run));
+    if (!memory->slab_runs)
+    {
+        return 0;
+    }
+    slab_runs_build(memory);
+    return 1;
+}
+
+// Marca "count" páginas a partir de "first" como livres (1) ou ocupadas (0) no mapa de páginas
+static void slab_mark_pages(mymemory_t *memory, size_t first, size_t count, int free_pages)
+{
+    // Sequências livres vizinhas: ao liberar elas se juntam à nova, ao ocupar elas são o que sobra da antiga
+    int neighbours = (first > 0 && slab_page_is_free(memory, first - 1)) + (first + count < memory->slab_page_count && slab_page_is_free(memory, first + count));
+    memory->counters.free_blocks += free_pages ? 1 - (size_t)neighbours : (size_t)neighbours - 1;
+    for (size_t i = first; i < first + count; i++)
+    {
+        if (free_pages)
+        {
+            memory->slab_free_map[i / 64] |= 1ULL << (i % 64);
+        }
+        else
+        {
+            memory->slab_free_map[i / 64] &= ~(1ULL << (i % 64));
+        }
+    }
+    slab_runs_update(memory, first, count, free_pages);
+    memory->counters.largest_free_block = (size_t)memory->slab_runs[1].best * MYMEMORY_SLAB_PAGE;  // Raiz da árvore: sempre exato
+}
+
+// Procura "count" páginas livres consecutivas cuja primeira começa em endereço múltiplo de "alignment" (-1 se não houver)
+static long slab_find_pages(mymemory_t *memory, size_t count, size_t alignment)
+{
+    size_t words = (memory->slab_page_count + 63) / 64;
+    size_t i = 0;
+
+    while (i + count <= memory->slab_page_count)
+    {
+        uint64_t bits = memory->slab_free_map[i / 64] >> (i % 64);  // Pula de uma vez as páginas ocupadas
+        if (!bits)
+        {
+            i = (i / 64 + 1) * 64;
+            if (i / 64 >= words)
+            {
+                break;
+            }
+            continue;
+        }
+        i += (size_t)__builtin_ctzll(bits);  // Primeira página livre a partir de i
+        if (i + count > memory->slab_page_count)
+        {
+            break;
+        }
+        if ((uintptr_t)((char *)memory->pool + i * MYMEMORY_SLAB_PAGE) & (alignment - 1))
+        {
+            i++;  // Endereço sem o alinhamento pedido
+            continue;
+        }
+        size_t run = 1;
+        while (run < count && (memory->slab_free_map[(i + run) / 64] >> ((i + run) % 64)) & 1)
+        {
+            run++;
+        }
+        if (run == count)
+        {
+            return (long)i;
+        }
+        i += run;  // A sequência foi interrompida: continua depois dela
+    }
+    return -1;
+}
+
+// Retira uma página da lista de páginas parciais da sua classe
+static void slab_partial_unlink(mymemory_t *memory, int32_t index)
+{
+    struct mymemory_slab_page *page = &memory->slab_pages[index];
+    if (page->prev_partial >= 0)
+    {
+        memory->slab_pages[page->prev_partial].next_partial = page->next_partial;
+    }
+    else
+    {
+        memory->slab_partial[page->cls] = page->next_partial;
+    }
+    if (page->next_partial >= 0)
+    {
+        memory->slab_pages[page->next_partial].prev_partial = page->prev_partial;
+    }
+}
+
+// Coloca uma página no início da lista de páginas parciais da sua classe
+static void slab_partial_push(mymemory_t *memory, int32_t index)
+{
+    struct mymemory_slab_page *page = &memory->slab_pages[index];
+    page->prev_partial = -1;
+    page->next_partial = memory->slab_partial[page->cls];
+    if (page->next_partial >= 0)
+    {
+        memory->slab_pages[page->next_partial].prev_partial = index;
+    }
+    memory->slab_partial[page->cls] = index;
+}
+
+// Alocação na estratégia Slab: objetos pequenos em páginas por classe, objetos grandes em sequências de páginas
+static void *slab_alloc(mymemory_t *memory, size_t size, size_t alignment)
+{
+    if (size <= MYMEMORY_SLAB_MAX_SIZE && alignment <= MYMEMORY_SLAB_MAX_SIZE) // Objeto pequeno
+    {
+        int cls = slab_class(size > alignment ? size : alignment);
+        size_t object_size = slab_class_size(cls);
+        int32_t index = memory->slab_partial[cls];  // Página com posição livre
+
+        if (index < 0) // Nenhuma página parcial: inicia uma página nova para a classe
+        {
+            long first = slab_find_pages(memory, 1, 1);
+            if (first < 0)
+            {
+                return NULL;  // Sem páginas livres
+            }
+            index = (int32_t)first;
+            slab_mark_pages(memory, (size_t)index, 1, 0);
+            struct mymemory_slab_page *page = &memory->slab_pages[index];
+            size_t slots = MYMEMORY_SLAB_PAGE / object_size;  // Objetos por página
+            memset(page->free_slots, 0, sizeof(page->free_slots));
+            for (size_t w = 0; w < slots / 64; w++)
+            {
+                page->free_slots[w] = ~0ULL;  // Palavras inteiras de posições livres
+            }
+            if (slots % 64)
+            {
+                page->free_slots[slots / 64] = (1ULL << (slots % 64)) - 1;
+            }
+            page->kind = SLAB_PAGE_OBJECTS;
+            page->cls = (uint8_t)cls;
+            page->used = 0;
+            slab_partial_push(memory, index);
+        }
+
+        struct mymemory_slab_page *page = &memory->slab_pages[index];
+        int w = 0;
+        while (!page->free_slots[w]) // Primeira palavra com posição livre
+        {
+            w++;
+        }
+        int bit = __builtin_ctzll(page->free_slots[w]);  // Primeira posição livre da palavra
+        page->free_slots[w] &= page->free_slots[w] - 1;  // Ocupa a posição
+        page->used++;
+        memory->counters.allocated_blocks++;
+        stats_in_use_add(memory, object_size);
+        if ((size_t)page->used == MYMEMORY_SLAB_PAGE / object_size) // Página cheia: sai da lista de parciais
+        {
+            slab_partial_unlink(memory, index);
+        }
+        return (char *)memory->pool + (size_t)index * MYMEMORY_SLAB_PAGE + (size_t)(w * 64 + bit) * object_size;
+    }
+
+    // Objeto grande: sequência de páginas inteiras
+    size_t count = (size + MYMEMORY_SLAB_PAGE - 1) / MYMEMORY_SLAB_PAGE;
+    long first = slab_find_pages(memory, count, alignment > MYMEMORY_SLAB_PAGE ? alignment : 1);
+    if (first < 0)
+    {
+        return NULL;
+    }
+    slab_mark_pages(memory, (size_t)first, count, 0);
+    memory->slab_pages[first].kind = SLAB_PAGE_LARGE;
+    memory->slab_pages[first].run = (uint32_t)count;
+    for (size_t i = 1; i < count; i++)
+    {
+        memory->slab_pages[first + (long)i].kind = SLAB_PAGE_LARGE_TAIL;
+    }
+    memory->counters.allocated_blocks++;
+    stats_in_use_add(memory, count * MYMEMORY_SLAB_PAGE);
+    return (char *)memory->pool + (size_t)first * MYMEMORY_SLAB_PAGE;
+}
+
+// Tamanho do objeto da estratégia Slab que começa em "ptr" (0 se o endereço não for o início de um objeto em uso)
+static size_t slab_object_size(mymemory_t *memory, void *ptr)
+{
+    size_t offset = (size_t)((char *)ptr - (char *)memory->pool);
+    if ((char *)ptr < (char *)memory->pool || offset >= memory->slab_page_count * MYMEMORY_SLAB_PAGE)
+    {
+        return 0;  // Fora das páginas do pool
+    }
+
+    struct mymemory_slab_page *page = &memory->slab_pages[offset / MYMEMORY_SLAB_PAGE];
+    size_t in_page = offset % MYMEMORY_SLAB_PAGE;
+    if (page->kind == SLAB_PAGE_LARGE && in_page == 0)
+    {
+        return (size_t)page->run * MYMEMORY_SLAB_PAGE;
+    }
+    if (page->kind == SLAB_PAGE_OBJECTS)
+    {
+        size_t object_size = slab_class_size(page->cls);
+        size_t slot = in_page / object_size;
+        if (in_page % object_size == 0 && !((page->free_slots[slot / 64] >> (slot % 64)) & 1)) // Início de uma posição ocupada
+        {
+            return object_size;
+        }
+    }
+    return 0;
+}
+
+// Liberação na estratégia Slab; retorna 0 se o endereço não for o início de um objeto em uso
+static int slab_free(mymemory_t *memory, void *ptr)
+{
+    size_t size = slab_object_size(memory, ptr);
+    if (!size)
+    {
+        return 0;  // Endereço inválido ou objeto já liberado
+    }
+    memory->counters.allocated_blocks--;
+    memory->counters.bytes_in_use -= size;
+
+    size_t offset = (size_t)((char *)ptr - (char *)memory->pool);
+    int32_t index = (int32_t)(offset / MYMEMORY_SLAB_PAGE);
+    struct mymemory_slab_page *page = &memory->slab_pages[index];
+
+    if (page->kind == SLAB_PAGE_LARGE) // Devolve a sequência inteira
+    {
+        for (uint32_t i = 0; i < page->run; i++)
+        {
+            memory->slab_pages[index + (int32_t)i].kind = SLAB_PAGE_FREE;
+        }
+        slab_mark_pages(memory, (size_t)index, page->run, 1);
+        return 1;
+    }
+
+    size_t object_size = slab_class_size(page->cls);
+    size_t slot = (offset % MYMEMORY_SLAB_PAGE) / object_size;
+    int was_full = (size_t)page->used == MYMEMORY_SLAB_PAGE / object_size;
+    page->free_slots[slot / 64] |= 1ULL << (slot % 64);  // Libera a posição
+    page->used--;
+    if (was_full) // Voltou a ter posição livre
+    {
+        slab_partial_push(memory, index);
+    }
+    if (page->used == 0 && (page->prev_partial >= 0 || page->next_partial >= 0)) // Página vazia e a classe tem outras: devolve a página
+    {
+        slab_partial_unlink(memory, index);
+        page->kind = SLAB_PAGE_FREE;
+        slab_mark_pages(memory, (size_t)index, 1, 1);
+    }
+    return 1;
+}
+
+// Encadeamento das listas de livres do Buddy, guardado dentro do próprio bloco livre (deslocamentos no pool)
+struct mymemory_buddy_link {
+    size_t next;  // Próximo bloco livre da mesma ordem (SIZE_MAX = nenhum)
+    size_t prev;  // Bloco livre anterior da mesma ordem (SIZE_MAX = nenhum)
+};
+
+#define BUDDY_ORDER_NONE 0xFF  // Nenhum bloco alocado começa no grânulo
+#define BUDDY_ORDER_EXACT 0x80  // O bloco tem exatamente o tamanho pedido (sem tamanho guardado no final)
+
+// Tamanho dos blocos de uma ordem (16, 32, 64, ...)
+static size_t buddy_block_size(int order)
+{
+    return (size_t)MYMEMORY_GRANULE << order;
+}
+
+// Menor ordem cujos blocos comportam "size" bytes
+static int buddy_order_for(size_t size)
+{
+    return size <= MYMEMORY_GRANULE ? 0 : (64 - __builtin_clzll((unsigned long long)(size - 1))) - 4;
+}
+
+// Encadeamento guardado no bloco livre que começa em "offset"
+static struct mymemory_buddy_link *buddy_link(mymemory_t *memory, size_t offset)
+{
+    return (struct mymemory_buddy_link *)((char *)memory->pool + offset);
+}
+
+// Palavra do bitmap da ordem "order" que contém o bit do bloco em "offset"
+static uint64_t *buddy_map_word(mymemory_t *memory, int order, size_t offset)
+{
+    size_t bit = offset >> (order + 4);
+    return &memory->buddy_map[memory->buddy_map_offset[order] + bit / 64];
+}
+
+// Indica se o bloco da ordem "order" que começa em "offset" está livre
+static int buddy_is_free(mymemory_t *memory, int order, size_t offset)
+{
+    return (int)((*buddy_map_word(memory, order, offset) >> ((offset >> (order + 4)) % 64)) & 1);
+}
+
+// Coloca um bloco livre no início da lista da sua ordem e liga o seu bit
+static void buddy_push(mymemory_t *memory, size_t offset, int order)
+{
+    struct mymemory_buddy_link *link = buddy_link(memory, offset);
+    link->prev = SIZE_MAX;
+    link->next = memory->buddy_free[order];
+    if (link->next != SIZE_MAX)
+    {
+        buddy_link(memory, link->next)->prev = offset;
+    }
+    memory->buddy_free[order] = offset;
+    *buddy_map_word(memory, order, offset) |= 1ULL << ((offset >> (order + 4)) % 64);
+    memory->buddy_nonempty |= 1ULL << order;
+    stats_free_added(memory, buddy_block_size(order));
+}
+
+// Retira um bloco livre da lista da sua ordem e desliga o seu bit
+static void buddy_unlink(mymemory_t *memory, size_t offset, int order)
+{
+    struct mymemory_buddy_link *link = buddy_link(memory, offset);
+    if (link->prev != SIZE_MAX)
+    {
+        buddy_link(memory, link->prev)->next = link->next;
+    }
+    else
+    {
+        memory->buddy_free[order] = link->next;
+    }
+    if (link->next != SIZE_MAX)
+    {
+        buddy_link(memory, link->next)->prev = link->prev;
+    }
+    *buddy_map_word(memory, order, offset) &= ~(1ULL << ((offset >> (order + 4)) % 64));
+    if (memory->buddy_free[order] == SIZE_MAX)
+    {
+        memory->buddy_nonempty &= ~(1ULL << order);  // Ordem sem blocos livres
+    }
+    stats_free_removed(memory, buddy_block_size(order));
+}
+
+// Devolve um bloco livre, juntando-o ao seu par enquanto o par também estiver livre
+static void buddy_release(mymemory_t *memory, size_t offset, int order)
+{
+    while (order + 1 < MYMEMORY_BUDDY_ORDERS)
+    {
+        size_t buddy = offset ^ buddy_block_size(order);  // O par difere só no bit da ordem
+        if (!buddy_is_free(memory, order, buddy))
+        {
+            break;
+        }
+        buddy_unlink(memory, buddy, order);
+        offset &= ~buddy_block_size(order);  // O bloco juntado começa no menor dos dois
+        order++;
+    }
+    buddy_push(memory, offset, order);
+}
+
+// Prepara bitmaps, listas e ordens; o pool é coberto pelos maiores blocos alinhados que couberem nele
+// Retorna 0 se faltar memória para as tabelas
+static int buddy_init(mymemory_t *memory)
+{
+    size_t granules = memory->total_size / MYMEMORY_GRANULE;  // Um resto menor que um grânulo fica sem uso
+    size_t words = 0;
+
+    for (int order = 0; order < MYMEMORY_BUDDY_ORDERS; order++)
+    {
+        memory->buddy_map_offset[order] = words;
+        words += (granules >> order) / 64 + 1;  // Um bit por bloco possível da ordem
+        memory->buddy_free[order] = SIZE_MAX;
+    }
+    if (!memory->buddy_map)
+    {
+        memory->buddy_map = (uint64_t *)malloc(words * sizeof(uint64_t));
+        memory->buddy_order = (uint8_t *)malloc(granules + 1);
+        if (!memory->buddy_map || !memory->buddy_order)
+        {
+            return 0;
+        }
+    }
+    memset(memory->buddy_map, 0, words * sizeof(uint64_t));
+    memset(memory->buddy_order, BUDDY_ORDER_NONE, granules + 1);
+    memory->buddy_nonempty = 0;
+    memory->buddy_requested = 0;
+    stats_reset(memory);
+
+    size_t limit = granules * MYMEMORY_GRANULE;
+    size_t offset = 0;
+    while (offset < limit)
+    {
+        int order = 0;  // Maior ordem alinhada em "offset" que ainda cabe no pool
+        while (order + 1 < MYMEMORY_BUDDY_ORDERS && !(offset & buddy_block_size(order)) && offset + buddy_block_size(order + 1) <= limit)
+        {
+            order++;
+        }
+        buddy_push(memory, offset, order);
+        offset += buddy_block_size(order);
+    }
+    return 1;
+}
+
+// Marca o bloco de ordem "order" em "offset" como alocado para "size" bytes
+static void buddy_set_allocated(mymemory_t *memory, size_t offset, int order, size_t size)
+{
+    size_t block_size = buddy_block_size(order);
+    if (size == block_size)
+    {
+        memory->buddy_order[offset / MYMEMORY_GRANULE] = (uint8_t)(order | BUDDY_ORDER_EXACT);
+    }
+    else // Sobra pelo menos um grânulo no final do bloco: o tamanho pedido fica guardado ali
+    {
+        memory->buddy_order[offset / MYMEMORY_GRANULE] = (uint8_t)order;
+        *(size_t *)((char *)memory->pool + offset + block_size - sizeof(size_t)) = size;
+    }
+    memory->buddy_requested += size;
+    memory->counters.allocated_blocks++;
+    stats_in_use_add(memory, block_size);
+}
+
+// Ordem do bloco alocado que começa em "ptr" (-1 se o endereço não for o início de um bloco alocado)
+static int buddy_allocated_order(mymemory_t *memory, void *ptr, size_t *offset)
+{
+    *offset = (size_t)((char *)ptr - (char *)memory->pool);
+    if ((char *)ptr < (char *)memory->pool || *offset >= memory->total_size || *offset % MYMEMORY_GRANULE)
+    {
+        return -1;
+    }
+    uint8_t order = memory->buddy_order[*offset / MYMEMORY_GRANULE];
+    return order == BUDDY_ORDER_NONE ? -1 : (order & ~BUDDY_ORDER_EXACT);
+}
+
+// Desfaz a contabilidade do bloco alocado em "offset" e devolve os bytes que tinham sido pedidos
+static size_t buddy_clear_allocated(mymemory_t *memory, size_t offset, int order)
+{
+    size_t block_size = buddy_block_size(order);
+    size_t size = (memory->buddy_order[offset / MYMEMORY_GRANULE] & BUDDY_ORDER_EXACT)
+                      ? block_size
+                      : *(size_t *)((char *)memory->pool + offset + block_size - sizeof(size_t));
+    memory->buddy_order[offset / MYMEMORY_GRANULE] = BUDDY_ORDER_NONE;
+    memory->buddy_requested -= size;
+    memory->counters.allocated_blocks--;
+    memory->counters.bytes_in_use -= block_size;
+    return size;
+}
+
+// Alocação no Buddy: a menor ordem com bloco livre vem do bitmap de ordens e é dividida ao meio até o tamanho pedido
+static void *buddy_alloc(mymemory_t *memory, size_t size, size_t alignment)
+{
+    int want = buddy_order_for(size > alignment ? size : alignment);  // Blocos da ordem ficam alinhados ao próprio tamanho
+    if (want >= MYMEMORY_BUDDY_ORDERS)
+    {
+        return NULL;
+    }
+    if (alignment > ((uintptr_t)memory->pool & -(uintptr_t)memory->pool))
+    {
+        return NULL;  // Os blocos ficam alinhados no máximo como o início do pool
+    }
+    uint64_t candidates = memory->buddy_nonempty & (~0ULL << want);  // Ordens com bloco livre grande o bastante
+    if (!candidates)
+    {
+        return NULL;
+    }
+
+    int order = __builtin_ctzll(candidates);
+    size_t offset = memory->buddy_free[order];
+    buddy_unlink(memory, offset, order);
+    while (order > want) // Divide ao meio: a metade de cima volta livre, a de baixo continua alinhada
+    {
+        order--;
+        buddy_push(memory, offset + buddy_block_size(order), order);
+    }
+    buddy_set_allocated(memory, offset, want, size);
+    return (char *)memory->pool + offset;
+}
+
+// Liberação no Buddy; retorna 0 se o endereço não for o início de um bloco alocado
+static int buddy_free(mymemory_t *memory, void *ptr)
+{
+    size_t offset;
+    int order = buddy_allocated_order(memory, ptr, &offset);
+    if (order < 0)
+    {
+        return 0;  // Endereço inválido ou bloco já liberado
+    }
+    buddy_clear_allocated(memory, offset, order);
+    buddy_release(memory, offset, order);
+    return 1;
+}
+
+// Extensão (livre ou alocada) que começa em "offset", para percorrer o Buddy em ordem de endereços
+static size_t buddy_extent(mymemory_t *memory, size_t offset, int *is_free)
+{
+    uint8_t allocated = memory->buddy_order[offset / MYMEMORY_GRANULE];
+    if (allocated != BUDDY_ORDER_NONE)
+    {
+        *is_free = 0;
+        return buddy_block_size(allocated & ~BUDDY_ORDER_EXACT);
+    }
+    *is_free = 1;
+    for (int order = 0; order < MYMEMORY_BUDDY_ORDERS && !(offset & (buddy_block_size(order) - 1)); order++)
+    {
+        if (buddy_is_free(memory, order, offset))
+        {
+            return buddy_block_size(order);
+        }
+    }
+    return MYMEMORY_GRANULE;  // Não acontece com o Buddy consistente
+}
+
+// Aloca um bloco de "size" bytes (já arredondado) cujo início é múltiplo de "alignment" com a estratégia do pool
+static void *strategy_alloc(mymemory_t *memory, size_t size, size_t alignment)
+{
+    allocation_t *current = memory->free_blocks;  // Ponteiro para percorrer os blocos livres
+    allocation_t *chosen = NULL;  // Bloco escolhido pela estratégia
+    INSTRUMENT_DECLARE(steps);  // Blocos livres examinados
+
+    switch (memory->strategy) // Seleciona a estratégia de alocação
+    {  
+        case FIRST_FIT: 
+            while (current) // Percorre a lista de blocos livres
+            {  
+                if (current->size >= alignment_padding(current, alignment) + size) // Verifica se o bloco atual é grande o suficiente
+                {  
+                    chosen = current;  // Primeiro bloco adequado encontrado
+                    break;
+                }
+                current = current->next;  // Avança o ponteiro
+                INSTRUMENT_STEP(steps);
+            }
+            break;
+
+        case BEST_FIT: 
+            chosen = size_tree_best(memory, size, alignment);  // Menor bloco adequado, pela árvore por tamanho
+            break;
+
+        case WORST_FIT:
+            chosen = size_tree_worst(memory, size, alignment);  // Maior bloco adequado, pela árvore por tamanho
+            break;
+
+        case SEGREGATED_FIT:
+            return segregated_alloc(memory, size, alignment);  // Busca em O(1) pelos bitmaps
+
+        case ARENA:
+            return arena_alloc(memory, size, alignment);  // Só avança o topo
+
+        case SLAB:
+            return slab_alloc(memory, size, alignment);  // Bitmap da página parcial da classe
+
+        case BUDDY:
+            return buddy_alloc(memory, size, alignment);  // Menor ordem livre pelo bitmap de ordens, depois divisões
+    }
+
+    INSTRUMENT_SEARCH(memory, 0, steps);
+    if (chosen) // Se um bloco adequado foi encontrado
+    {
+        return carve_free_block(memory, chosen, size, alignment_padding(chosen, alignment));
+    }
+    return NULL;  // Retorna NULL se nenhum bloco adequado foi encontrado
+}
+
+// Insere um bloco na lista de livres em ordem de endereços, fundindo-o com os vizinhos adjacentes
+// "hint", se não for NULL, é um bloco livre da lista com endereço menor: a busca começa nele em vez do início da lista
+// Retorna o bloco livre que passou a conter o bloco inserido (serve de "hint" para um endereço maior)
+static allocation_t *insert_free_block(mymemory_t *memory, allocation_t *block, allocation_t *hint)
+{
+    allocation_t *prev = hint;  // Último bloco livre antes do bloco inserido
+    allocation_t *current = hint ? hint->next : memory->free_blocks;  // Primeiro bloco livre depois do bloco inserido
+    size_t old_size = 0;  // Chave de um vizinho livre que passa a conter o bloco (0 = nenhum)
+    char *old_start = NULL;
+    INSTRUMENT_DECLARE(steps);  // Blocos livres percorridos
+
+    block->is_free = 1;
+    while (current && current->start < block->start) // Procura a posição pelo endereço
+    {
+        prev = current;
+        current = current->next;
+        INSTRUMENT_STEP(steps);
+    }
+    INSTRUMENT_SEARCH(memory, 1, steps);
+
+    if (current && block->phys_next == current) // Vizinho seguinte é contíguo
+    {
+        old_size = current->size;  // O bloco herda a posição do vizinho na árvore por tamanho
+        old_start = (char *)current->start;
+        current = current->next;  // Pula o bloco absorvido
+        absorb_next(memory, block);  // Absorve o bloco seguinte
+    }
+
+    if (prev && prev->phys_next == block) // Vizinho anterior é contíguo
+    {
+        if (old_size) // Fundido com os dois vizinhos: o seguinte deixa de existir
+        {
+            free_key_removed(memory, old_size, old_start);
+        }
+        old_size = prev->size;
+        old_start = (char *)prev->start;
+        absorb_next(memory, prev);  // O anterior absorve o bloco inserido
+        block = prev;
+    }
+    else if (prev)
+    {
+        prev->next = block;  // Encadeia depois do anterior
+        block->prev = prev;
+    }
+    else
+    {
+        memory->free_blocks = block;  // Bloco passa a ser o primeiro da lista
+        block->prev = NULL;
+    }
+
+    block->next = current;  // Encadeia com o próximo
+    if (current)
+    {
+        current->prev = block;
+    }
+    if (old_size)
+    {
+        free_block_changed(memory, block, old_size, old_start);  // Já com o tamanho depois das fusões
+    }
+    else
+    {
+        free_block_added(memory, block);
+    }
+    return block;
+}
+
+// Retira um bloco da lista de alocados e do índice
+static void unregister_allocated(mymemory_t *memory, allocation_t *current)
+{
+    if (current->prev) 
+    {
+        current->prev->next = current->next; // Remove o bloco da lista de alocados
+    } 
+    else 
+    {
+        memory->allocated_blocks = current->next; // Atualiza o início da lista alocada, se o bloco era o primeiro
+    }
+    if (current->next)
+    {
+        current->next->prev = current->prev; // Mantém o encadeamento duplo
+    }
+    index_remove(memory, current); // Retira o bloco do índice
+    memory->counters.allocated_blocks--;
+    memory->counters.bytes_in_use -= current->size;
+}
+
+// Pool crescente: marca como residentes as regiões tocadas por um bloco recém-alocado
+static void regions_touch(mymemory_t *memory, void *ptr, size_t size)
+{
+    size_t offset = (size_t)((char *)ptr - (char *)memory->pool);
+    for (size_t region = offset / memory->region_size; region <= (offset + size - 1) / memory->region_size; region++)
+    {
+        memory->region_resident[region / 64] |= 1ULL << (region % 64);
+    }
+}
+
+// Pool crescente: devolve ao sistema as páginas das regiões residentes inteiramente dentro do trecho livre [start, end)
+static void regions_release(mymemory_t *memory, size_t start, size_t end)
+{
+    size_t first = (start + memory->region_size - 1) / memory->region_size;  // Primeira região inteira do trecho
+    size_t last = end / memory->region_size;  // Primeira região depois do trecho
+
+    for (size_t region = first; region < last;)
+    {
+        uint64_t word = memory->region_resident[region / 64] >> (region % 64);
+        if (!word) // Nenhuma região residente no resto da palavra
+        {
+            region = (region | 63) + 1;
+            continue;
+        }
+        region += (size_t)__builtin_ctzll(word);
+        size_t run = region;  // Regiões residentes consecutivas: uma chamada ao sistema para todas
+        while (run < last && (memory->region_resident[run / 64] >> (run % 64)) & 1)
+        {
+            memory->region_resident[run / 64] &= ~(1ULL << (run % 64));
+            run++;
+        }
+        if (region < last)
+        {
+            madvise((char *)memory->pool + region * memory->region_size, (run - region) * memory->region_size, MADV_DONTNEED);
+        }
+        region = run;
+    }
+}
+
+// Libera a memória de um trecho livre [start, end) do pool crescente; no pool fixo não faz nada
+static void regions_release_range(mymemory_t *memory, size_t start, size_t end)
+{
+    if (memory->region_size)
+    {
+        regions_release(memory, start, end);
+    }
+}
+
+// Devolve um bloco que não está em nenhuma lista às estruturas de livres da estratégia, fundindo com vizinhos livres
+static allocation_t *return_free_block(mymemory_t *memory, allocation_t *block)
+{
+    if (memory->strategy == SEGREGATED_FIT)
+    {
+        block = segregated_free(memory, block); // Devolve o bloco à lista da sua classe, fundindo com vizinhos livres
+    }
+    else
+    {
+        block = insert_free_block(memory, block, NULL); // Devolve o bloco à lista de livres, fundindo com vizinhos livres
+    }
+    size_t offset = (size_t)((char *)block->start - (char *)memory->pool);
+    regions_release_range(memory, offset, offset + block->size);  // Regiões que ficaram inteiramente livres voltam ao sistema
+    return block;
+}
+
+// Pool crescente: habilita regiões novas no fim do pool até caber um bloco de "size" bytes alinhado a "alignment"
+// Retorna 1 se o pool cresceu
+static int pool_grow(mymemory_t *memory, size_t size, size_t alignment)
+{
+    allocation_t *last = NULL;  // Último bloco do encadeamento físico
+    size_t tail_free;  // Bytes livres no fim do pool, que o bloco novo pode aproveitar
+
+    if (!memory->region_size || memory->total_size == memory->max_size)
+    {
+        return 0;
+    }
+    if (memory->strategy == ARENA)
+    {
+        tail_free = memory->total_size - memory->arena_top;
+    }
+    else
+    {
+        for (last = memory->head; last->phys_next; last = last->phys_next) // O crescimento é raro: percorre o encadeamento
+        {
+        }
+        tail_free = last->is_free ? last->size : 0;
+    }
+
+    size_t end = memory->total_size - tail_free + size + alignment - memory->alignment;  // Pior caso do preenchimento de alinhamento
+    end = (end + memory->region_size - 1) / memory->region_size * memory->region_size;
+    if (end > memory->max_size || !tables_commit(memory, end) ||
+        mprotect((char *)memory->pool + memory->total_size, end - memory->total_size, PROT_READ | PROT_WRITE) != 0)
+    {
+        return 0;  // Nem o pool inteiro atenderia o pedido, ou o sistema recusou
+    }
+
+    if (last) // As regiões novas formam um bloco livre depois do último, fundido com ele se estiver livre
+    {
+        allocation_t *block = descriptor_acquire(memory);
+        block->start = (char *)memory->pool + memory->total_size;
+        block->size = end - memory->total_size;
+        block->owner = 0;
+        block->phys_prev = last;
+        block->phys_next = NULL;
+        last->phys_next = block;
+        memory->total_size = end;
+        return_free_block(memory, block);
+    }
+    memory->total_size = end;
+    return 1;
+}
+
+// Aloca no pool compartilhado um bloco de "size" bytes (já arredondado) cujo início é múltiplo de "alignment"
+// Quem chama valida os parâmetros e, no modo concorrente, segura o lock do pool
+static void *pool_alloc(mymemory_t *memory, size_t size, size_t alignment)
+{
+    void *ptr = strategy_alloc(memory, size, alignment);
+    if (!ptr && pool_grow(memory, size, alignment)) // Pool crescente: tenta de novo com as regiões novas
+    {
+        ptr = strategy_alloc(memory, size, alignment);
+    }
+    if (ptr && memory->region_size)
+    {
+        regions_touch(memory, ptr, size);
+    }
+    return ptr;
+}
+
+// Devolve ao pool compartilhado um bloco alocado, fundindo-o com os vizinhos livres
+static void release_block(mymemory_t *memory, allocation_t *current)
+{
+    unregister_allocated(memory, current);
+    return_free_block(memory, current);
+}
+
+// Libera um bloco no pool compartilhado, qualquer que seja a estratégia; retorna 0 se o endereço não for o início de um bloco alocado
+// Quem chama segura o lock do pool no modo concorrente
+static int pool_free(mymemory_t *memory, void *ptr)
+{
+    if (memory->strategy == SLAB)
+    {
+        return slab_free(memory, ptr);
+    }
+    if (memory->strategy == BUDDY)
+    {
+        return buddy_free(memory, ptr);
+    }
+    allocation_t *block = index_find(memory, ptr); // Consulta o índice em vez de percorrer a lista
+    if (!block || block->handle) // Blocos de handles só saem por mymemory_hfree
+    {
+        return 0;
+    }
+    release_block(memory, block);
+    return 1;
+}
+
+// Modo de depuração: cada bloco tem, depois dos bytes pedidos, uma zona de guarda com GUARD_CANARY terminada pelo
+// tamanho pedido (embaralhado com GUARD_KEY). Na liberação a zona é conferida, o início do bloco é preenchido com
+// GUARD_POISON e o bloco espera na quarentena; ao sair dela, o envenenamento é conferido antes de o bloco voltar ao pool.
+#define GUARD_CANARY 0xFD  // Byte das zonas de guarda
+#define GUARD_POISON 0xDD  // Byte que preenche os blocos liberados
+#define GUARD_KEY 0x9E3779B97F4A7C15ULL  // Embaralha o tamanho pedido, para que bytes quaisquer não pareçam um tamanho válido
+
+// Registra um problema encontrado pelo modo de depuração; sempre vai para stderr, com ou sem verbose
+static void guard_report(mymemory_t *memory, const char *problem, void *ptr)
+{
+    memory->counters.guard_errors++;
+    fprintf(stderr, "mymemory: %s (endereco %p)\n", problem, ptr);
+}
+
+// Escreve a zona de guarda de um bloco com "requested" bytes úteis
+static void guard_arm(allocation_t *block, size_t requested)
+{
+    char *trailer = (char *)block->start + block->size - sizeof(uint64_t);  // Tamanho pedido, no fim do bloco
+    uint64_t value = (uint64_t)requested ^ GUARD_KEY;
+
+    memset((char *)block->start + requested, GUARD_CANARY, (size_t)(trailer - (char *)block->start) - requested);
+    memcpy(trailer, &value, sizeof(value));
+}
+
+// Tamanho pedido de um bloco protegido, lido do fim do bloco; SIZE_MAX se a zona de guarda foi sobrescrita
+static size_t guard_requested(allocation_t *block)
+{
+    char *trailer = (char *)block->start + block->size - sizeof(uint64_t);
+    uint64_t value;
+
+    memcpy(&value, trailer, sizeof(value));
+    size_t requested = (size_t)(value ^ GUARD_KEY);
+    if (requested > block->size - MYMEMORY_GUARD_SIZE)
+    {
+        return SIZE_MAX;  // O fim do bloco não guarda mais um tamanho possível
+    }
+    for (const unsigned char *byte = (unsigned char *)block->start + requested; byte < (unsigned char *)trailer; byte++)
+    {
+        if (*byte != GUARD_CANARY)
+        {
+            return SIZE_MAX;
+        }
+    }
+    return requested;
+}
+
+// Bytes envenenados de um bloco liberado: limitar a uma linha de cache mantém o custo fixo em blocos grandes
+static size_t guard_poison_size(allocation_t *block)
+{
+    return MYMEMORY_POISON_SIZE && block->size > MYMEMORY_POISON_SIZE ? MYMEMORY_POISON_SIZE : block->size;
+}
+
+// Indica se um bloco da quarentena continua envenenado (ninguém escreveu nele depois da liberação)
+static int guard_poisoned(allocation_t *block)
+{
+    const uint64_t poison = 0x0101010101010101ULL * GUARD_POISON;
+    const uint64_t *word = (const uint64_t *)block->start;  // Blocos começam alinhados a MYMEMORY_GRANULE
+    size_t words = guard_poison_size(block) / sizeof(uint64_t);
+    uint64_t differ = 0;
+
+    for (size_t i = 0; i < words; i++) // Sem desvio dentro do laço: o compilador vetoriza
+    {
+        differ |= word[i] ^ poison;
+    }
+    return differ == 0;
+}
+
+// Devolve ao pool os "count" blocos mais antigos da quarentena, conferindo o envenenamento de cada um
+static void quarantine_drain(mymemory_t *memory, size_t count)
+{
+    while (count-- && memory->quarantine_count)
+    {
+        allocation_t *block = memory->quarantine[memory->quarantine_head];
+        memory->quarantine_head = (memory->quarantine_head + 1) % MYMEMORY_QUARANTINE;
+        memory->quarantine_count--;
+        if (!guard_poisoned(block))
+        {
+            guard_report(memory, "bloco alterado depois de liberado", block->start);
+        }
+        block->quarantined = 0;
+        release_block(memory, block);
+    }
+}
+
+// Aloca no modo de depuração um bloco com "size" bytes úteis seguidos da zona de guarda
+// Quem chama segura o lock do pool no modo concorrente
+static void *guard_alloc(mymemory_t *memory, size_t size, size_t alignment)
+{
+    if (size > memory->max_size - MYMEMORY_GUARD_SIZE)
+    {
+        return NULL;
+    }
+    size_t total = (size + MYMEMORY_GUARD_SIZE + memory->alignment - 1) & ~(memory->alignment - 1);
+    void *ptr = pool_alloc(memory, total, alignment);
+    if (!ptr && memory->quarantine_count) // A quarentena nunca causa falta de espaço: esvazia e tenta de novo
+    {
+        quarantine_drain(memory, memory->quarantine_count);
+        ptr = pool_alloc(memory, total, alignment);
+    }
+    if (ptr)
+    {
+        guard_arm(index_find(memory, ptr), size);
+    }
+    return ptr;
+}
+
+// Envenena o início de um bloco liberado e o põe na quarentena no lugar do mais antigo
+static void guard_quarantine(mymemory_t *memory, allocation_t *block)
+{
+    memset(block->start, GUARD_POISON, guard_poison_size(block));
+    block->quarantined = 1;
+    if (memory->quarantine_count == MYMEMORY_QUARANTINE)
+    {
+        quarantine_drain(memory, 1);
+    }
+    memory->quarantine[(memory->quarantine_head + memory->quarantine_count) % MYMEMORY_QUARANTINE] = block;
+    memory->quarantine_count++;
+}
+
+// Liberação no modo de depuração; retorna 0 se o endereço não é o início de um bloco alocado
+// O índice encontra também os blocos na quarentena, o que distingue uma liberação dupla de um endereço qualquer
+static int guard_free(mymemory_t *memory, void *ptr)
+{
+    allocation_t *block = index_find(memory, ptr);
+    if (!block || block->handle)
+    {
+        guard_report(memory, "liberacao de endereco que nao e o inicio de um bloco alocado", ptr);
+        return 0;
+    }
+    if (block->quarantined)
+    {
+        guard_report(memory, "liberacao dupla", ptr);
+        return 0;
+    }
+    if (guard_requested(block) == SIZE_MAX)
+    {
+        guard_report(memory, "zona de guarda sobrescrita depois do bloco", ptr);
+    }
+    guard_quarantine(memory, block);
+    return 1;
+}
+
+// Slots de thread: cada thread ativa recebe um número em [0, MYMEMORY_MAX_THREADS) que indexa seu cache em cada pool.
+// O slot é devolvido quando a thread termina (destrutor da chave), e a próxima thread que o receber herda os caches.
+static pthread_once_t thread_slot_once = PTHREAD_ONCE_INIT;
+static pthread_key_t thread_slot_key;
+static _Atomic uint64_t thread_slots_in_use;  // Bit i ligado se o slot i pertence a uma thread viva
+static _Thread_local int thread_slot = -1;  // Slot da thread atual (-1 enquanto não tiver um)
+
+// Destrutor da chave: libera o slot da thread que terminou
+static void thread_slot_release(void *value)
+{
+    int slot = (int)(intptr_t)value - 1;
+    atomic_fetch_and(&thread_slots_in_use, ~(1ULL << slot));
+}
+
+static void thread_slot_key_create(void)
+{
+    pthread_key_create(&thread_slot_key, thread_slot_release);
+}
+
+// Retorna o slot da thread atual, reservando um na primeira chamada (-1 se todos estiverem ocupados)
+static int current_thread_slot(void)
+{
+    if (thread_slot >= 0)
+    {
+        return thread_slot;
+    }
+
+    pthread_once(&thread_slot_once, thread_slot_key_create);
+    uint64_t used = atomic_load(&thread_slots_in_use);
+    while (~used) // Ainda existe slot livre
+    {
+        int slot = __builtin_ctzll(~used);  // Primeiro slot livre
+        if (atomic_compare_exchange_weak(&thread_slots_in_use, &used, used | (1ULL << slot)))
+        {
+            thread_slot = slot;
+            pthread_setspecific(thread_slot_key, (void *)(intptr_t)(slot + 1));  // Garante a devolução ao terminar
+            return slot;
+        }
+    }
+    return -1;  // Sem slot: a thread usa sempre o pool compartilhado
+}
+
+// Empilha um bloco em uma classe do cache
+static void cache_push(struct mymemory_thread_cache *cache, int cls, void *ptr)
+{
+    *(void **)ptr = cache->bins[cls];
+    cache->bins[cls] = ptr;
+    cache->counts[cls]++;
+}
+
+// Devolve ao pool compartilhado "count" blocos de uma classe do cache (uma única aquisição do lock)
+static void cache_flush(mymemory_t *memory, struct mymemory_thread_cache *cache, int cls, unsigned count)
+{
+    pool_lock(memory);
+    while (count-- && cache->bins[cls])
+    {
+        void *ptr = cache->bins[cls];
+        cache->bins[cls] = *(void **)ptr;
+        cache->counts[cls]--;
+
+        allocation_t *block = index_find(memory, ptr);
+        block->owner = 0;  // O bloco deixa de pertencer ao cache
+        block->cached = 0;
+        release_block(memory, block);
+    }
+    pool_unlock(memory);
+}
+
+// Move para as pilhas locais os blocos que outras threads liberaram
+static void cache_drain_remote(mymemory_t *memory, struct mymemory_thread_cache *cache)
+{
+    void *ptr = atomic_exchange(&cache->remote_frees, NULL);  // Esvazia a pilha remota de uma vez (sem ABA)
+    while (ptr)
+    {
+        void *next = *(void **)ptr;
+        allocation_t *block = index_find(memory, ptr);
+        cache_push(cache, (int)(block->size >> memory->alignment_shift) - 1, ptr);
+        ptr = next;
+    }
+}
+
+// Aloca um bloco pequeno do cache da thread, reabastecendo em lote quando a classe estiver vazia
+static void *cache_alloc(mymemory_t *memory, size_t size)
+{
+    int slot = current_thread_slot();
+    if (slot < 0)
+    {
+        return NULL;  // Sem cache para esta thread
+    }
+
+    struct mymemory_thread_cache *cache = &memory->thread_caches[slot];
+    int cls = (int)(size >> memory->alignment_shift) - 1;  // Classe: tamanho em unidades de alocação
+
+    if (!cache->bins[cls] && atomic_load_explicit(&cache->remote_frees, memory_order_relaxed))
+    {
+        cache_drain_remote(memory, cache);  // Reaproveita primeiro o que outras threads devolveram
+    }
+    if (!cache->bins[cls]) // Reabastece a classe com um lote do pool compartilhado
+    {
+        pool_lock(memory);
+        for (int i = 0; i < MYMEMORY_CACHE_BATCH; i++)
+        {
+            void *ptr = pool_alloc(memory, size, memory->alignment);
+            if (!ptr)
+            {
+                break;  // Pool sem espaço: fica com o que conseguiu
+            }
+            allocation_t *block = index_find(memory, ptr);
+            block->owner = slot + 1;
+            block->cached = 1;
+            cache_push(cache, cls, ptr);
+        }
+        pool_unlock(memory);
+        if (!cache->bins[cls])
+        {
+            return NULL;
+        }
+    }
+
+    void *ptr = cache->bins[cls];  // Desempilha sem lock
+    cache->bins[cls] = *(void **)ptr;
+    cache->counts[cls]--;
+    index_find(memory, ptr)->cached = 0;  // Volta a estar com o usuário
+    return ptr;
+}
+
+// Libera um bloco que pertence a algum cache de thread
+// Retorna 0 se o bloco não pertence a nenhum cache, 1 se foi liberado e -1 se já estava livre em um cache (liberação dupla)
+static int cache_free(mymemory_t *memory, void *ptr)
+{
+    allocation_t *block = index_find(memory, ptr);
+    if (!block || !block->owner)
+    {
+        return 0;
+    }
+    if (block->cached) // Empilhar de novo faria duas alocações futuras receberem o mesmo endereço
+    {
+        return -1;
+    }
+    block->cached = 1;
+
+    int slot = current_thread_slot();
+    if (block->owner == slot + 1) // Bloco do próprio cache: empilha sem lock
+    {
+        struct mymemory_thread_cache *cache = &memory->thread_caches[slot];
+        int cls = (int)(block->size >> memory->alignment_shift) - 1;
+        cache_push(cache, cls, ptr);
+        if (cache->counts[cls] > 2 * MYMEMORY_CACHE_BATCH) // Cache cheio demais: devolve um lote ao pool
+        {
+            cache_flush(memory, cache, cls, MYMEMORY_CACHE_BATCH);
+        }
+    }
+    else // Bloco de outra thread: entra na pilha remota do dono
+    {
+        struct mymemory_thread_cache *owner = &memory->thread_caches[block->owner - 1];
+        void *head = atomic_load_explicit(&owner->remote_frees, memory_order_relaxed);
+        do
+        {
+            *(void **)ptr = head;
+        } while (!atomic_compare_exchange_weak_explicit(&owner->remote_frees, &head, ptr, memory_order_release, memory_order_relaxed));
+    }
+    return 1;
+}
+
+// Enfileira uma liberação na fila da thread atual; retorna 0 se a thread não tem slot ou a fila está cheia (a liberação é feita na hora)
+static int defer_push(mymemory_t *memory, void *ptr)
+{
+    int slot = current_thread_slot();
+    if (slot < 0)
+    {
+        return 0;
+    }
+
+    struct mymemory_defer_queue *queue = &memory->defer_queues[slot];
+    size_t tail = atomic_load_explicit(&queue->producer.tail, memory_order_relaxed);
+    if (tail - queue->producer.head_cache >= MYMEMORY_DEFER_QUEUE) // Parece cheia: confere quanto já foi drenado
+    {
+        queue->producer.head_cache = atomic_load_explicit(&queue->consumer.head, memory_order_acquire);
+        if (tail - queue->producer.head_cache >= MYMEMORY_DEFER_QUEUE)
+        {
+            return 0;
+        }
+    }
+    queue->ptrs[tail % MYMEMORY_DEFER_QUEUE] = ptr;
+    atomic_store_explicit(&queue->producer.tail, tail + 1, memory_order_release);  // Publica o endereço para quem drena
+    if (tail + 1 - queue->producer.head_cache == MYMEMORY_DEFER_QUEUE / 2) // Meia fila: acorda a thread de manutenção antes do intervalo
+    {
+        pthread_cond_signal(&memory->defer_wake);
+    }
+    return 1;
+}
+
+// Modo verboso: confere se "ptr" pode ser liberado antes de enfileirá-lo, para que a mensagem "adiada" só saia para
+// endereços válidos; os demais seguem pelo caminho síncrono, que os reporta. Sem o modo verboso nada é conferido aqui
+static int defer_valid(mymemory_t *memory, void *ptr)
+{
+    size_t offset;
+    int valid;
+
+    pool_lock(memory);
+    if (memory->strategy == SLAB)
+    {
+        valid = slab_object_size(memory, ptr) != 0;
+    }
+    else if (memory->strategy == BUDDY)
+    {
+        valid = buddy_allocated_order(memory, ptr, &offset) >= 0;
+    }
+    else
+    {
+        allocation_t *block = index_find(memory, ptr);
+        valid = block && !block->handle && !block->quarantined;
+    }
+    pool_unlock(memory);
+    return valid;
+}
+
+// Identificador de um bloco no trace: a posição do seu início em unidades de alocação
+static unsigned long trace_id(mymemory_t *memory, void *ptr)
+{
+    return (unsigned long)(((char *)ptr - (char *)memory->pool) >> memory->alignment_shift);
+}
+
+// Liga a gravação de trace em "out" (NULL desliga); cada operação bem-sucedida vira uma linha do arquivo
+// Formato: "a <id> <tamanho> [alinhamento]", "f <id>", "r <id> <novo id> <tamanho>" e "x" (reset)
+void mymemory_trace(mymemory_t *memory, FILE *out)
+{
+    if (out)
+    {
+        fprintf(out, "# mymemory-trace 1 %lu %lu %s\n", (unsigned long)memory->total_size, (unsigned long)memory->alignment,
+                strategy_name(memory->strategy));  // Tamanho do pool e alinhamento usados na gravação
+    }
+    else if (memory->trace)
+    {
+        fflush(memory->trace);
+    }
+    memory->trace = out;
+}
+
+// Grava a liberação antes de ela acontecer: o endereço só pode ser reaproveitado (e gravado de novo) depois
+static void trace_free(mymemory_t *memory, void *ptr)
+{
+    size_t offset = (size_t)((char *)ptr - (char *)memory->pool);
+    if ((char *)ptr >= (char *)memory->pool && offset < memory->total_size && !(offset & (memory->alignment - 1)))
+    {
+        fprintf(memory->trace, "f %lu\n", trace_id(memory, ptr));
+    }
+}
+
+// Aloca um bloco cujo início é múltiplo de "alignment" (potência de 2), sem gravar no trace
+static void *alloc_aligned_untraced(mymemory_t *memory, size_t size, size_t alignment)
+{
+    if (size == 0 || size > memory->max_size || (alignment & (alignment - 1))) // Blocos vazios quebrariam a ordem de endereços da lista de livres
+    {
+        return NULL;
+    }
+    if (alignment < memory->alignment)
+    {
+        alignment = memory->alignment;  // Todo bloco já tem pelo menos o alinhamento do pool
+    }
+    size_t rounded = (size + memory->alignment - 1) & ~(memory->alignment - 1);  // Arredonda para a unidade de alocação
+
+    pool_lock(memory);
+    void *ptr = memory->harden ? guard_alloc(memory, size, alignment) : pool_alloc(memory, rounded, alignment);
+    if (!ptr && memory->defer_queues) // Pode faltar só o que ainda espera nas filas: faz as liberações adiadas e tenta de novo
+    {
+        pool_unlock(memory);
+        mymemory_flush(memory);  // defer_lock vem sempre antes do lock do pool
+        pool_lock(memory);
+        ptr = memory->harden ? guard_alloc(memory, size, alignment) : pool_alloc(memory, rounded, alignment);
+    }
+    if (!ptr)
+    {
+        memory->counters.failed_allocations++;
+    }
+    pool_unlock(memory);
+    return ptr;
+}
+
+// Função para alocar um bloco de memória, sem gravar no trace
+static void *alloc_untraced(mymemory_t *memory, size_t size)
+{
+    if (memory->concurrent && uses_descriptors(memory) && !memory->harden && size && size <= MYMEMORY_CACHE_MAX_SIZE) // Blocos pequenos vêm do cache da thread
+    {
+        size = (size + memory->alignment - 1) & ~(memory->alignment - 1);
+        void *ptr = cache_alloc(memory, size);
+        if (ptr)
+        {
+            return ptr;
+        }
+    }
+    return alloc_aligned_untraced(memory, size, memory->alignment);  // Alinhamento mínimo do pool
+}
+
+// Função para alocar um bloco de memória
+void* mymemory_alloc(mymemory_t *memory, size_t size)
+{
+    INSTRUMENT_BEGIN(start);
+    void *ptr = alloc_untraced(memory, size);
+    INSTRUMENT_END(memory, 0, size, start);
+    if (memory->trace && ptr)
+    {
+        fprintf(memory->trace, "a %lu %lu\n", trace_id(memory, ptr), (unsigned long)size);
+    }
+    return ptr;
+}
+
+// Aloca um bloco cujo início é múltiplo de "alignment" (potência de 2)
+void* mymemory_alloc_aligned(mymemory_t *memory, size_t size, size_t alignment)
+{
+    INSTRUMENT_BEGIN(start);
+    void *ptr = alloc_aligned_untraced(memory, size, alignment);
+    INSTRUMENT_END(memory, 0, size, start);
+    if (memory->trace && ptr)
+    {
+        fprintf(memory->trace, "a %lu %lu %lu\n", trace_id(memory, ptr), (unsigned long)size, (unsigned long)alignment);
+    }
+    return ptr;
+}
+
+// Liberação na arena: só o último objeto devolve espaço; os demais esperam o reset ou o rollback
+static void arena_free(mymemory_t *memory, void *ptr)
+{
+    size_t offset = (size_t)((char *)ptr - (char *)memory->pool);
+
+    pool_lock(memory);
+    int valid = (char *)ptr >= (char *)memory->pool && offset < memory->arena_top && arena_is_start(memory, offset);  // Início de um objeto da área usada
+    int popped = valid && offset == memory->arena_last;
+    if (popped) // Desfaz a última alocação
+    {
+        memory->arena_top = offset;  // A marca do objeto fica acima do topo e deixa de valer
+        memory->arena_last = SIZE_MAX;  // O objeto anterior não é conhecido
+        memory->arena_count--;
+        regions_release_range(memory, offset, memory->total_size);
+    }
+    pool_unlock(memory);
+
+    if (!memory->verbose)
+    {
+        return;
+    }
+    if (popped)
+    {
+        printf("Memoria no endereco 0x%p liberada.\n", ptr);
+    }
+    else
+    {
+        printf(valid ? "Memoria no endereco 0x%p sera liberada no reset da arena.\n" : "O endereco 0x%p nao corresponde ao inicio de um objeto da arena.\n", ptr);
+    }
+}
+
+// Função para liberar memória, sem gravar no trace
+static void free_untraced(mymemory_t *memory, void *ptr)
+{
+    if (memory->strategy == ARENA)
+    {
+        arena_free(memory, ptr);
+        return;
+    }
+    int cached = memory->concurrent && uses_descriptors(memory) ? cache_free(memory, ptr) : 0;
+    if (cached) // Blocos dos caches de thread não passam pelo lock
+    {
+        if (cached < 0 && memory->verbose)
+        {
+            printf("O endereco fornecido nao corresponde ao inicio de um bloco alocado.\n");
+        }
+        return;
+    }
+    if (memory->defer_queues && ptr && (!memory->verbose || defer_valid(memory, ptr)) && defer_push(memory, ptr)) // Liberação adiada: o lock do pool e a junção com os vizinhos ficam para a thread de manutenção
+    {
+        if (memory->verbose)
+        {
+            printf("Liberacao do endereco 0x%p adiada.\n", ptr);
+        }
+        return;
+    }
+
+    pool_lock(memory);
+    int released = memory->harden ? guard_free(memory, ptr) : pool_free(memory, ptr); // Libera o bloco
+    pool_unlock(memory);
+
+    if (!memory->verbose)
+    {
+        return;  // Uso como biblioteca: sem mensagens
+    }
+    if (!released) 
+    {
+        printf("O endereco fornecido nao corresponde ao inicio de um bloco alocado.\n");
+    }
+    else
+    {
+        printf("Memoria no endereco 0x%p liberada.\n", ptr); // Mensagem de sucesso
+    }
+}
+
+#ifdef MYMEMORY_INSTRUMENT
+// Tamanho do bloco alocado que começa em "ptr" (0 se não houver), para a classe de tamanho da liberação
+static size_t instrument_block_size(mymemory_t *memory, void *ptr)
+{
+    size_t size = 0;
+    size_t offset;
+
+    if (memory->thread_caches && uses_descriptors(memory)) // Bloco de algum cache: o tamanho não muda enquanto ele tem dono, como em cache_free
+    {
+        allocation_t *block = index_find(memory, ptr);
+        if (block && block->owner)
+        {
+            return block->size;
+        }
+    }
+    pool_lock(memory);
+    if (memory->strategy == SLAB)
+    {
+        size = slab_object_size(memory, ptr);
+    }
+    else if (memory->strategy == BUDDY)
+    {
+        int order = buddy_allocated_order(memory, ptr, &offset);
+        size = order >= 0 ? buddy_block_size(order) : 0;
+    }
+    else if (uses_descriptors(memory))
+    {
+        allocation_t *block = index_find(memory, ptr);
+        size = block ? block->size : 0;
+    }
+    pool_unlock(memory);
+    return size;  // Arena: sem tamanho por objeto
+}
+#endif
+
+// Função para liberar memória
+void mymemory_free(mymemory_t *memory, void *ptr)
+{
+    if (memory->trace && ptr)
+    {
+        trace_free(memory, ptr);
+    }
+#ifdef MYMEMORY_INSTRUMENT
+    size_t size = instrument_block_size(memory, ptr);  // Antes de liberar, fora do tempo medido
+#endif
+    INSTRUMENT_BEGIN(start);
+    free_untraced(memory, ptr);
+    INSTRUMENT_END(memory, 1, size, start);
+}
+
+
+// Separa o final de um bloco em uma nova entrada, que fica fisicamente logo depois dele e fora de qualquer lista
+// O bloco original fica só com os primeiros "size" bytes
+static allocation_t *split_back(mymemory_t *memory, allocation_t *block, size_t size)
+{
+    allocation_t *tail = descriptor_acquire(memory);  // Nova entrada para o final do bloco
+    tail->start = (char *)block->start + size;
+    tail->size = block->size - size;
+    tail->owner = 0;
+    tail->phys_prev = block;  // Insere o final logo depois do bloco no encadeamento físico
+    tail->phys_next = block->phys_next;
+    if (block->phys_next)
+    {
+        block->phys_next->phys_prev = tail;
+    }
+    block->phys_next = tail;
+    block->size = size;
+    return tail;
+}
+
+// Devolve ao pool o final de um bloco alocado, que fica só com os primeiros "size" bytes
+static void shrink_block(mymemory_t *memory, allocation_t *block, size_t size)
+{
+    memory->counters.bytes_in_use -= block->size - size;
+    return_free_block(memory, split_back(memory, block, size));  // Funde com o vizinho seguinte, se estiver livre
+}
+
+// Tenta aumentar um bloco alocado até "size" bytes ocupando o bloco livre seguinte; retorna 1 se conseguiu
+static int grow_in_place(mymemory_t *memory, allocation_t *block, size_t size)
+{
+    allocation_t *next = block->phys_next;  // Vizinho físico seguinte
+    size_t needed = size - block->size;  // Bytes que faltam
+
+    if (!next || !next->is_free || next->size < needed)
+    {
+        return 0;  // Não há espaço livre logo depois do bloco
+    }
+
+    if (memory->strategy == SEGREGATED_FIT)
+    {
+        segregated_remove(memory, next);  // A classe do vizinho vai mudar
+    }
+    stats_in_use_add(memory, needed);
+    if (next->size > needed) // O vizinho só encolhe: perde os primeiros bytes
+    {
+        size_t old_size = next->size;
+        char *old_start = (char *)next->start;
+        next->start = (char *)next->start + needed;
+        next->size -= needed;
+        block->size = size;
+        if (memory->strategy == SEGREGATED_FIT)
+        {
+            segregated_insert(memory, next);
+        }
+        else
+        {
+            free_block_changed(memory, next, old_size, old_start);  // Continua na mesma posição da lista ordenada por endereços
+        }
+    }
+    else // O vizinho é consumido por inteiro
+    {
+        if (memory->strategy != SEGREGATED_FIT)
+        {
+            free_block_removed(memory, next);
+            free_list_unlink(memory, next);
+        }
+        absorb_next(memory, block);
+    }
+    return 1;
+}
+
+// Realocação na arena: o último objeto muda de tamanho no lugar; os demais são copiados para o topo
+static void *arena_realloc(mymemory_t *memory, void *ptr, size_t size)
+{
+    size_t offset = (size_t)((char *)ptr - (char *)memory->pool);
+    void *moved = NULL;
+
+    pool_lock(memory);
+    if ((char *)ptr < (char *)memory->pool || offset >= memory->arena_top || !arena_is_start(memory, offset))
+    {
+        pool_unlock(memory);
+        return NULL;  // Não é o início de um objeto da área usada
+    }
+    if (offset == memory->arena_last && (memory->total_size - offset >= size || (pool_grow(memory, size, memory->alignment) && memory->total_size - offset >= size))) // Último objeto: só move o topo
+    {
+        arena_set_top(memory, offset + size);
+        if (memory->region_size)
+        {
+            regions_touch(memory, ptr, size);
+            regions_release(memory, memory->arena_top, memory->total_size);  // Se o objeto diminuiu
+        }
+        arena_track_peak(memory);
+        pool_unlock(memory);
+        return ptr;
+    }
+    size_t old_size = arena_object_size(memory, offset);  // Até o próximo objeto: os dados dos seguintes não são copiados
+    moved = pool_alloc(memory, size, memory->alignment);
+    if (moved)
+    {
+        memcpy(moved, ptr, old_size < size ? old_size : size);
+    }
+    else
+    {
+        memory->counters.failed_allocations++;  // O bloco original continua válido
+    }
+    pool_unlock(memory);
+    return moved;
+}
+
+// Realocação no Slab: fica no lugar se o novo tamanho ainda cabe no objeto e não desperdiça mais da metade dele
+static void *slab_realloc(mymemory_t *memory, void *ptr, size_t size)
+{
+    pool_lock(memory);
+    size_t old_size = slab_object_size(memory, ptr);
+    if (!old_size)
+    {
+        pool_unlock(memory);
+        return NULL;  // Não é o início de um objeto em uso
+    }
+    if (size <= old_size && size > old_size / 2)
+    {
+        pool_unlock(memory);
+        return ptr;  // Mesma classe (ou mesma quantidade de páginas, aproximadamente)
+    }
+    void *moved = slab_alloc(memory, size, memory->alignment);
+    if (moved)
+    {
+        memcpy(moved, ptr, old_size < size ? old_size : size);
+        slab_free(memory, ptr);
+    }
+    else
+    {
+        memory->counters.failed_allocations++;  // O bloco original continua válido
+    }
+    pool_unlock(memory);
+    return moved;
+}
+
+// Realocação no Buddy: encolhe devolvendo metades de cima e cresce absorvendo pares livres; só copia se o par estiver ocupado
+static void *buddy_realloc(mymemory_t *memory, void *ptr, size_t size)
+{
+    pool_lock(memory);
+    size_t offset;
+    int order = buddy_allocated_order(memory, ptr, &offset);
+    if (order < 0)
+    {
+        pool_unlock(memory);
+        return NULL;  // Não é o início de um bloco alocado
+    }
+
+    int want = buddy_order_for(size);
+    int grow = order;  // Maior ordem alcançável no lugar
+    while (grow < want && !(offset & buddy_block_size(grow)) && buddy_is_free(memory, grow, offset + buddy_block_size(grow)))
+    {
+        grow++;  // O bloco é a metade de baixo e o par de cima está livre
+    }
+    if (want <= order || grow == want)
+    {
+        buddy_clear_allocated(memory, offset, order);
+        for (; order < want; order++) // Absorve os pares de cima
+        {
+            buddy_unlink(memory, offset + buddy_block_size(order), order);
+        }
+        while (order > want) // Devolve as metades de cima que sobraram
+        {
+            order--;
+            buddy_push(memory, offset + buddy_block_size(order), order);
+        }
+        buddy_set_allocated(memory, offset, want, size);
+        pool_unlock(memory);
+        return ptr;
+    }
+
+    void *moved = buddy_alloc(memory, size, memory->alignment);  // Último caso: muda de lugar
+    if (moved)
+    {
+        size_t old_size = buddy_clear_allocated(memory, offset, order);
+        memcpy(moved, ptr, old_size);
+        buddy_release(memory, offset, order);
+    }
+    else
+    {
+        memory->counters.failed_allocations++;  // O bloco original continua válido
+    }
+    pool_unlock(memory);
+    return moved;
+}
+
+// Realocação no modo de depuração: a zona de guarda é conferida e escrita de novo no fim do bloco
+static void *guard_realloc(mymemory_t *memory, void *ptr, size_t size)
+{
+    if (size > memory->max_size - MYMEMORY_GUARD_SIZE)
+    {
+        return NULL;
+    }
+    size_t total = (size + MYMEMORY_GUARD_SIZE + memory->alignment - 1) & ~(memory->alignment - 1);
+
+    pool_lock(memory);
+    allocation_t *block = index_find(memory, ptr);
+    if (!block || block->handle || block->quarantined)
+    {
+        guard_report(memory, block && block->quarantined ? "realocacao de bloco ja liberado" : "realocacao de endereco que nao e o inicio de um bloco alocado", ptr);
+        pool_unlock(memory);
+        return NULL;
+    }
+    size_t requested = guard_requested(block);  // Bytes válidos no bloco atual
+    if (requested == SIZE_MAX)
+    {
+        guard_report(memory, "zona de guarda sobrescrita depois do bloco", ptr);
+        requested = block->size - MYMEMORY_GUARD_SIZE;  // Copia tudo o que pode ser dado útil
+    }
+
+    if (total < block->size) // Encolhe no lugar: o final volta para a lista de livres
+    {
+        shrink_block(memory, block, total);
+    }
+    if (total <= block->size || grow_in_place(memory, block, total))
+    {
+        guard_arm(block, size);
+        pool_unlock(memory);
+        return ptr;
+    }
+
+    void *moved = guard_alloc(memory, size, memory->alignment);  // Último caso: muda de lugar
+    if (moved)
+    {
+        memcpy(moved, ptr, requested < size ? requested : size);
+        guard_quarantine(memory, block);  // O bloco antigo também passa pela quarentena
+    }
+    else
+    {
+        memory->counters.failed_allocations++;  // O bloco original continua válido
+    }
+    pool_unlock(memory);
+    return moved;
+}
+
+// Muda o tamanho de um bloco alocado, sem gravar no trace ("ptr" válido e "size" maior que 0)
+static void *realloc_untraced(mymemory_t *memory, void *ptr, size_t size)
+{
+    if (size > memory->max_size)
+    {
+        return NULL;  // Nunca caberia no pool; o bloco original continua válido
+    }
+    size_t rounded = (size + memory->alignment - 1) & ~(memory->alignment - 1);  // Arredonda para a unidade de alocação
+
+    if (memory->strategy == ARENA)
+    {
+        return arena_realloc(memory, ptr, rounded);
+    }
+    if (memory->strategy == SLAB)
+    {
+        return slab_realloc(memory, ptr, rounded);
+    }
+    if (memory->strategy == BUDDY)
+    {
+        return buddy_realloc(memory, ptr, rounded);
+    }
+    if (memory->harden)
+    {
+        return guard_realloc(memory, ptr, size);
+    }
+
+    pool_lock(memory);
+    allocation_t *block = index_find(memory, ptr);
+    if (!block || block->handle) // Blocos de handles não são realocados por ponteiro
+    {
+        pool_unlock(memory);
+        if (memory->verbose)
+        {
+            printf("O endereco fornecido nao corresponde ao inicio de um bloco alocado.\n");
+        }
+        return NULL;
+    }
+
+    size_t old_size = block->size;  // Bytes válidos no bloco atual
+    if (!block->owner) // Bloco do pool compartilhado
+    {
+        if (rounded < block->size) // Encolhe no lugar: o final volta para a lista de livres
+        {
+            shrink_block(memory, block, rounded);
+        }
+        if (rounded <= block->size || grow_in_place(memory, block, rounded))
+        {
+            pool_unlock(memory);
+            return ptr;  // O bloco continua no mesmo endereço
+        }
+
+        void *moved = pool_alloc(memory, rounded, memory->alignment);  // Último caso: muda de lugar
+        if (moved)
+        {
+            memcpy(moved, ptr, old_size);
+            release_block(memory, block);
+        }
+        else
+        {
+            memory->counters.failed_allocations++;  // O bloco original continua válido
+        }
+        pool_unlock(memory);
+        return moved;
+    }
+    pool_unlock(memory);
+
+    // Blocos dos caches de thread têm o tamanho fixo da sua classe: mudar de tamanho é sempre mudar de lugar
+    if (rounded == old_size)
+    {
+        return ptr;
+    }
+    void *moved = alloc_untraced(memory, size);
+    if (moved)
+    {
+        memcpy(moved, ptr, old_size < rounded ? old_size : rounded);
+        free_untraced(memory, ptr);
+    }
+    return moved;
+}
+
+// Muda o tamanho de um bloco alocado; cresce ou encolhe no lugar sempre que possível e só copia em último caso
+void* mymemory_realloc(mymemory_t *memory, void *ptr, size_t size)
+{
+    if (!ptr)
+    {
+        return mymemory_alloc(memory, size);  // Equivale a uma alocação
+    }
+    if (size == 0)
+    {
+        mymemory_free(memory, ptr);  // Equivale a uma liberação
+        return NULL;
+    }
+    if (!memory->trace)
+    {
+        return realloc_untraced(memory, ptr, size);
+    }
+
+    flockfile(memory->trace);  // O endereço antigo só volta ao trace (alocado por outra thread) depois desta linha
+    void *moved = realloc_untraced(memory, ptr, size);
+    if (moved)
+    {
+        fprintf(memory->trace, "r %lu %lu %lu\n", trace_id(memory, ptr), trace_id(memory, moved), (unsigned long)size);
+    }
+    funlockfile(memory->trace);
+    return moved;
+}
+
+// Aloca um vetor de "count" elementos de "size" bytes, todo zerado
+void* mymemory_calloc(mymemory_t *memory, size_t count, size_t size)
+{
+    if (size && count > SIZE_MAX / size)
+    {
+        return NULL;  // count * size estouraria
+    }
+    void *ptr = mymemory_alloc(memory, count * size);
+    if (ptr)
+    {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+// Aloca "count" blocos de "size" bytes de uma vez, sem gravar no trace
+static size_t alloc_batch_untraced(mymemory_t *memory, size_t size, size_t count, void **out_ptrs)
+{
+    if (size == 0 || count == 0 || size > memory->max_size)
+    {
+        return 0;
+    }
+    size_t rounded = (size + memory->alignment - 1) & ~(memory->alignment - 1);  // Arredonda para a unidade de alocação
+
+    pool_lock(memory);
+    if (memory->strategy == ARENA) // Na arena o lote é um único avanço do topo
+    {
+        char *base = count <= memory->max_size / rounded ? (char *)pool_alloc(memory, rounded * count, memory->alignment) : NULL;
+        for (size_t i = 0; base && i < count; i++)
+        {
+            out_ptrs[i] = base + i * rounded;
+            arena_mark_start(memory, (size_t)((char *)out_ptrs[i] - (char *)memory->pool));
+        }
+        if (base)
+        {
+            memory->arena_count += count - 1;
+            memory->arena_last = (size_t)((char *)out_ptrs[count - 1] - (char *)memory->pool);
+        }
+        memory->counters.failed_allocations += !base;
+        pool_unlock(memory);
+        return base ? count : 0;
+    }
+
+    void *first = NULL;
+    if (uses_descriptors(memory) && !memory->harden && count <= memory->max_size / rounded) // O lote inteiro pode caber em uma região só
+    {
+        first = pool_alloc(memory, rounded * count, memory->alignment);  // Uma única busca para o lote todo
+    }
+    if (first) // Divide a região em "count" blocos alocados independentes
+    {
+        allocation_t *block = index_find(memory, first);
+        out_ptrs[0] = first;
+        for (size_t i = 1; i < count; i++)
+        {
+            allocation_t *next = split_back(memory, block, rounded);
+            memory->counters.bytes_in_use -= next->size;  // Bytes já contados na região: o registro abaixo os conta de novo
+            register_allocated(memory, next);
+            out_ptrs[i] = next->start;
+            block = next;
+        }
+        pool_unlock(memory);
+        return count;
+    }
+
+    // Não há região contígua para o lote: aloca um a um, ainda com uma única aquisição do lock
+    size_t done;
+    for (done = 0; done < count; done++)
+    {
+        out_ptrs[done] = memory->harden ? guard_alloc(memory, size, memory->alignment) : pool_alloc(memory, rounded, memory->alignment);
+        if (!out_ptrs[done])
+        {
+            break;
+        }
+    }
+    if (done < count) // Falhou no meio: desfaz para não deixar o lote pela metade
+    {
+        while (done--)
+        {
+            pool_free(memory, out_ptrs[done]);
+        }
+        memory->counters.failed_allocations++;
+        pool_unlock(memory);
+        return 0;
+    }
+    pool_unlock(memory);
+    return count;
+}
+
+// Aloca "count" blocos de "size" bytes de uma vez, recortados de uma única região livre quando possível
+// Os endereços são escritos em "out_ptrs"; retorna "count" em caso de sucesso ou 0 (nada fica alocado)
+size_t mymemory_alloc_batch(mymemory_t *memory, size_t size, size_t count, void **out_ptrs)
+{
+    size_t done = alloc_batch_untraced(memory, size, count, out_ptrs);
+    if (!done && count && memory->defer_queues) // Pode faltar só o que ainda espera nas filas de liberações adiadas
+    {
+        mymemory_flush(memory);
+        done = alloc_batch_untraced(memory, size, count, out_ptrs);
+    }
+    for (size_t i = 0; memory->trace && i < done; i++) // No trace o lote aparece como alocações individuais
+    {
+        fprintf(memory->trace, "a %lu %lu\n", trace_id(memory, out_ptrs[i]), (unsigned long)size);
+    }
+    return done;
+}
+
+// Compara dois endereços (qsort)
+static int compare_pointers(const void *a, const void *b)
+{
+    uintptr_t pa = (uintptr_t)*(void *const *)a;
+    uintptr_t pb = (uintptr_t)*(void *const *)b;
+    return (pa > pb) - (pa < pb);
+}
+
+// Libera "count" blocos de uma vez, sem gravar no trace; retorna quantos endereços não correspondem a blocos alocados
+static size_t free_batch_untraced(mymemory_t *memory, void **ptrs, size_t count)
+{
+    size_t invalid = 0;  // Endereços que não correspondem a blocos alocados
+
+    qsort(ptrs, count, sizeof(void *), compare_pointers);
+    if (memory->concurrent && uses_descriptors(memory)) // Blocos dos caches de thread voltam para os caches, sem lock
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            int cached = ptrs[i] ? cache_free(memory, ptrs[i]) : 0;
+            if (cached)
+            {
+                invalid += cached < 0;
+                ptrs[i] = NULL;
+            }
+        }
+    }
+
+    pool_lock(memory);
+    allocation_t *hint = NULL;  // Bloco livre mais recente: os próximos endereços são maiores
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!ptrs[i])
+        {
+            continue;
+        }
+        if (!uses_descriptors(memory)) // Slab e Buddy liberam cada bloco sem busca em lista
+        {
+            invalid += !pool_free(memory, ptrs[i]);
+            continue;
+        }
+        if (memory->harden) // Modo de depuração: cada bloco passa pela quarentena
+        {
+            invalid += !guard_free(memory, ptrs[i]);
+            continue;
+        }
+        allocation_t *block = index_find(memory, ptrs[i]);
+        if (!block || block->handle)
+        {
+            invalid++;
+            continue;
+        }
+        unregister_allocated(memory, block);
+        if (memory->strategy == SEGREGATED_FIT)
+        {
+            block = segregated_free(memory, block);  // Já é O(1) por bloco
+        }
+        else
+        {
+            block = hint = insert_free_block(memory, block, hint);  // Continua a busca de onde a anterior parou
+        }
+        size_t offset = (size_t)((char *)block->start - (char *)memory->pool);
+        regions_release_range(memory, offset, offset + block->size);
+    }
+    pool_unlock(memory);
+    return invalid;
+}
+
+// Libera "count" blocos de uma vez: ordena os endereços e os devolve em uma única passada pela lista de livres
+// O vetor é usado como área de trabalho: fica reordenado e as entradas devolvidas aos caches de thread viram NULL
+void mymemory_free_batch(mymemory_t *memory, void **ptrs, size_t count)
+{
+    if (memory->strategy == ARENA) // Na arena os objetos só voltam no reset ou no rollback
+    {
+        return;
+    }
+    size_t given = 0;  // Endereços não nulos: entradas NULL são puladas e não contam nos totais
+    for (size_t i = 0; i < count; i++)
+    {
+        if (ptrs[i])
+        {
+            given++;
+            if (memory->trace)
+            {
+                trace_free(memory, ptrs[i]);
+            }
+        }
+    }
+    size_t invalid = free_batch_untraced(memory, ptrs, count);
+
+    if (memory->verbose)
+    {
+        printf("%lu blocos liberados.\n", (unsigned long)(given - invalid));
+        if (invalid)
+        {
+            printf("%lu enderecos nao correspondem ao inicio de um bloco alocado.\n", (unsigned long)invalid);
+        }
+    }
+}
+
+// Drena as filas de liberações adiadas em lotes (chamada com defer_lock); cada lote toma o lock do pool uma vez
+static void defer_drain(mymemory_t *memory)
+{
+    void *batch[MYMEMORY_DEFER_QUEUE];
+
+    for (int slot = 0; slot < MYMEMORY_MAX_THREADS; slot++)
+    {
+        struct mymemory_defer_queue *queue = &memory->defer_queues[slot];
+        size_t head = atomic_load_explicit(&queue->consumer.head, memory_order_relaxed);
+        size_t tail = atomic_load_explicit(&queue->producer.tail, memory_order_acquire);
+        if (head == tail)
+        {
+            continue;
+        }
+
+        size_t count = tail - head;
+        for (size_t i = 0; i < count; i++)
+        {
+            batch[i] = queue->ptrs[(head + i) % MYMEMORY_DEFER_QUEUE];
+        }
+        atomic_store_explicit(&queue->consumer.head, tail, memory_order_release);  // As posições voltam para a thread dona
+        size_t invalid = free_batch_untraced(memory, batch, count);
+        if (invalid && memory->verbose)
+        {
+            printf("%lu liberacoes adiadas nao correspondem ao inicio de um bloco alocado.\n", (unsigned long)invalid);
+        }
+    }
+}
+
+// Thread de manutenção: a cada intervalo (ou quando uma fila passa da metade) faz as liberações adiadas
+// O maior bloco livre fica para mymemory_get_stats: aqui só o trabalho dos lotes toma o lock do pool
+static void *defer_worker(void *arg)
+{
+    mymemory_t *memory = (mymemory_t *)arg;
+
+    pthread_mutex_lock(&memory->defer_lock);
+    while (!memory->defer_stop)
+    {
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_nsec += MYMEMORY_DEFER_INTERVAL_US * 1000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+            deadline.tv_nsec %= 1000000000L;
+        }
+        pthread_cond_timedwait(&memory->defer_wake, &memory->defer_lock, &deadline);
+
+        defer_drain(memory);
+    }
+    pthread_mutex_unlock(&memory->defer_lock);
+    return NULL;
+}
+
+// Cria as filas, o lock, a condição e a thread de manutenção das liberações adiadas
+// Retorna 0 se alguma delas falhar, sem deixar nada criado; defer_queues só é preenchido com a thread já rodando
+static int defer_start(mymemory_t *memory)
+{
+    struct mymemory_defer_queue *queues;
+    pthread_condattr_t attr;
+
+    if (posix_memalign((void **)&queues, 64, MYMEMORY_MAX_THREADS * sizeof(*queues)) != 0) // Uma fila por slot de thread
+    {
+        return 0;
+    }
+    memset(queues, 0, MYMEMORY_MAX_THREADS * sizeof(*queues));
+    if (pthread_condattr_init(&attr) != 0)
+    {
+        free(queues);
+        return 0;
+    }
+    int ready = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC) == 0 && pthread_cond_init(&memory->defer_wake, &attr) == 0; // O intervalo não depende do relógio de parede
+    pthread_condattr_destroy(&attr);
+    if (!ready)
+    {
+        free(queues);
+        return 0;
+    }
+    if (pthread_mutex_init(&memory->defer_lock, NULL) != 0)
+    {
+        pthread_cond_destroy(&memory->defer_wake);
+        free(queues);
+        return 0;
+    }
+    memory->defer_queues = queues;  // A thread de manutenção já encontra as filas
+    if (pthread_create(&memory->defer_thread, NULL, defer_worker, memory) != 0)
+    {
+        memory->defer_queues = NULL;  // Sem thread: mymemory_cleanup não tem o que parar
+        pthread_mutex_destroy(&memory->defer_lock);
+        pthread_cond_destroy(&memory->defer_wake);
+        free(queues);
+        return 0;
+    }
+    return 1;
+}
+
+// Barreira das liberações adiadas: ao retornar, toda liberação enfileirada antes da chamada já foi feita
+void mymemory_flush(mymemory_t *memory)
+{
+    if (!memory->defer_queues)
+    {
+        return;  // Liberações síncronas: nada pendente
+    }
+    pthread_mutex_lock(&memory->defer_lock);
+    defer_drain(memory);
+    pthread_mutex_unlock(&memory->defer_lock);
+}
+
+// Entrada da tabela de handles: o descritor não muda quando o bloco muda de lugar, então o handle aponta para ele
+struct mymemory_handle {
+    allocation_t *block;  // Bloco referenciado (NULL = entrada livre)
+    uint32_t pins;  // Quantos mymemory_pin ainda não foram desfeitos; o bloco só se move com 0
+    uint32_t next_free;  // Próxima entrada livre (0 = nenhuma)
+    uint32_t generation;  // Muda a cada liberação: handles antigos para a mesma entrada deixam de valer
+};
+
+// Handle da entrada "index" na geração atual dela
+static mymemory_handle_t handle_make(mymemory_t *memory, uint32_t index)
+{
+    return (mymemory_handle_t)memory->handles[index].generation << 32 | index;
+}
+
+// Todas as entradas voltam a estar livres (reset do pool)
+static void handles_reset(mymemory_t *memory)
+{
+    memory->handle_free = 0;
+    for (uint32_t handle = memory->handle_capacity; handle-- > 1;)
+    {
+        if (memory->handles[handle].block) // Os handles distribuídos antes do reset deixam de valer
+        {
+            memory->handles[handle].generation++;
+        }
+        memory->handles[handle].block = NULL;
+        memory->handles[handle].next_free = memory->handle_free;
+        memory->handle_free = handle;
+    }
+    memory->compact_cursor = SIZE_MAX;
+}
+
+// Entrada da tabela para um handle válido (NULL se o handle não referencia nenhum bloco ou é de uma geração passada)
+static struct mymemory_handle *handle_entry(mymemory_t *memory, mymemory_handle_t handle)
+{
+    uint32_t index = (uint32_t)handle;
+    if (!index || index >= memory->handle_capacity || !memory->handles[index].block || memory->handles[index].generation != (uint32_t)(handle >> 32))
+    {
+        return NULL;
+    }
+    return &memory->handles[index];
+}
+
+// Aloca um bloco que o pool pode mudar de lugar na compactação; o endereço só é obtido com mymemory_pin
+// Só nas estratégias com descritores (First, Best, Worst e Segregated Fit) e fora de pools persistentes; retorna 0 se falhar
+mymemory_handle_t mymemory_halloc(mymemory_t *memory, size_t size)
+{
+    if (!uses_descriptors(memory) || memory->mapping || memory->harden || size == 0 || size > memory->max_size)
+    {
+        return 0;  // Handles só existem nos pools comuns com descritores, fora do modo de depuração
+    }
+    size = (size + memory->alignment - 1) & ~(memory->alignment - 1);  // Arredonda para a unidade de alocação
+
+    pool_lock(memory);
+    if (!memory->handle_free) // Tabela cheia: dobra de tamanho
+    {
+        uint32_t capacity = memory->handle_capacity ? memory->handle_capacity * 2 : 64;
+        struct mymemory_handle *handles = (struct mymemory_handle *)realloc(memory->handles, capacity * sizeof(struct mymemory_handle));
+        if (!handles)
+        {
+            pool_unlock(memory);
+            return 0;
+        }
+        for (uint32_t handle = capacity; handle-- > (memory->handle_capacity ? memory->handle_capacity : 1);) // Entradas novas na lista de livres
+        {
+            handles[handle].block = NULL;
+            handles[handle].generation = 0;
+            handles[handle].next_free = memory->handle_free;
+            memory->handle_free = handle;
+        }
+        memory->handles = handles;
+        memory->handle_capacity = capacity;
+    }
+
+    void *ptr = pool_alloc(memory, size, memory->alignment);  // Sem cache de thread: o bloco precisa ficar no pool compartilhado
+    if (!ptr)
+    {
+        memory->counters.failed_allocations++;
+        pool_unlock(memory);
+        return 0;
+    }
+    uint32_t index = memory->handle_free;
+    struct mymemory_handle *entry = &memory->handles[index];
+    memory->handle_free = entry->next_free;
+    entry->block = index_find(memory, ptr);
+    entry->pins = 0;
+    entry->block->handle = index;  // O bloco guarda só a entrada: a geração vale para quem recebe o handle
+    mymemory_handle_t handle = handle_make(memory, index);
+    pool_unlock(memory);
+    return handle;
+}
+
+// Fixa o bloco de um handle e retorna seu endereço atual, que vale até o mymemory_unpin correspondente
+void* mymemory_pin(mymemory_t *memory, mymemory_handle_t handle)
+{
+    void *ptr = NULL;
+
+    pool_lock(memory);
+    struct mymemory_handle *entry = handle_entry(memory, handle);
+    if (entry)
+    {
+        entry->pins++;
+        ptr = entry->block->start;
+    }
+    pool_unlock(memory);
+    return ptr;
+}
+
+// Desfaz um mymemory_pin: sem fixações pendentes, o bloco volta a poder mudar de lugar
+void mymemory_unpin(mymemory_t *memory, mymemory_handle_t handle)
+{
+    pool_lock(memory);
+    struct mymemory_handle *entry = handle_entry(memory, handle);
+    if (entry && entry->pins)
+    {
+        entry->pins--;
+    }
+    pool_unlock(memory);
+}
+
+// Libera o bloco de um handle; o handle deixa de valer
+void mymemory_hfree(mymemory_t *memory, mymemory_handle_t handle)
+{
+    pool_lock(memory);
+    struct mymemory_handle *entry = handle_entry(memory, handle);
+    if (entry)
+    {
+        allocation_t *block = entry->block;
+        block->handle = 0;  // Volta a ser um bloco comum para o pool_free
+        entry->block = NULL;
+        entry->generation++;  // Cópias deste handle deixam de valer, mesmo depois que a entrada for reaproveitada
+        entry->next_free = memory->handle_free;
+        memory->handle_free = (uint32_t)handle;
+        release_block(memory, block);
+    }
+    pool_unlock(memory);
+
+    if (memory->verbose && !entry)
+    {
+        printf("O handle fornecido nao corresponde a um bloco alocado.\n");
+    }
+}
+
+// Troca de lugar o bloco livre "gap" e o bloco alocado "block" logo depois dele, copiando o conteúdo para baixo
+// O espaço livre passa para depois do bloco, onde se funde com um vizinho seguinte livre
+static void compact_slide(mymemory_t *memory, allocation_t *gap, allocation_t *block)
+{
+    allocation_t *hint = NULL;  // Livre anterior na lista em ordem de endereços (First, Best e Worst Fit)
+
+    if (memory->strategy == SEGREGATED_FIT)
+    {
+        segregated_remove(memory, gap);
+    }
+    else
+    {
+        hint = gap->prev;
+        free_block_removed(memory, gap);
+        free_list_unlink(memory, gap);
+    }
+
+    memmove(gap->start, block->start, block->size);
+    index_remove(memory, block);
+    block->start = gap->start;
+    gap->start = (char *)block->start + block->size;
+    index_insert(memory, block);
+
+    block->phys_prev = gap->phys_prev;  // Ordem física: anterior, bloco, espaço livre, seguinte
+    if (block->phys_prev)
+    {
+        block->phys_prev->phys_next = block;
+    }
+    else
+    {
+        memory->head = block;
+    }
+    gap->phys_next = block->phys_next;
+    if (gap->phys_next)
+    {
+        gap->phys_next->phys_prev = gap;
+    }
+    block->phys_next = gap;
+    gap->phys_prev = block;
+
+    if (memory->strategy == SEGREGATED_FIT)
+    {
+        gap = segregated_free(memory, gap);
+    }
+    else
+    {
+        gap = insert_free_block(memory, gap, hint);
+    }
+    if (memory->region_size)
+    {
+        size_t offset = (size_t)((char *)gap->start - (char *)memory->pool);
+        regions_touch(memory, block->start, block->size);
+        regions_release(memory, offset, offset + gap->size);
+    }
+}
+
+// Compacta o pool aos poucos: blocos de handles não fixados descem para o espaço livre logo antes deles,
+// juntando a memória livre em um trecho contíguo no fim do pool. Blocos comuns e fixados ficam onde estão.
+// Cada chamada continua de onde a anterior parou e trabalha por até "budget_ns" nanossegundos (0 = sem limite)
+// Retorna 1 se o percurso chegou ao fim do pool e 0 se o tempo acabou antes
+int mymemory_compact(mymemory_t *memory, uint64_t budget_ns)
+{
+    struct timespec t0, now;
+    int done = 1;
+
+    if (!uses_descriptors(memory))
+    {
+        return 1;  // Nada a mover
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    pool_lock(memory);
+    allocation_t *cursor = memory->compact_cursor == SIZE_MAX ? NULL : index_find(memory, (char *)memory->pool + memory->compact_cursor);
+    allocation_t *block = cursor ? cursor->phys_next : memory->head;  // Bloco visitado por último ainda alocado: continua dele
+
+    for (; block; block = block->phys_next)
+    {
+        allocation_t *gap = block->phys_prev;
+        if (!block->is_free && block->handle && !memory->handles[block->handle].pins && gap && gap->is_free)
+        {
+            compact_slide(memory, gap, block);
+        }
+        if (!block->is_free)
+        {
+            memory->compact_cursor = (size_t)((char *)block->start - (char *)memory->pool);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (budget_ns && (uint64_t)(now.tv_sec - t0.tv_sec) * 1000000000ULL + (uint64_t)(now.tv_nsec - t0.tv_nsec) >= budget_ns)
+        {
+            done = !block->phys_next;
+            break;
+        }
+    }
+    if (done)
+    {
+        memory->compact_cursor = SIZE_MAX;  // A próxima chamada recomeça do início
+    }
+    pool_unlock(memory);
+    return done;
+}
+
+// Marca a posição atual da arena; um rollback para a marca libera tudo o que foi alocado depois dela
+mymemory_marker_t mymemory_mark(mymemory_t *memory)
+{
+    mymemory_marker_t marker = { 0, SIZE_MAX, 0 };
+
+    pool_lock(memory);
+    if (memory->strategy == ARENA)
+    {
+        marker.top = memory->arena_top;
+        marker.last = memory->arena_last;
+        marker.count = memory->arena_count;
+    }
+    pool_unlock(memory);
+    return marker;
+}
+
+// Volta a arena para uma marca em O(1); marcas posteriores deixam de valer
+void mymemory_rollback(mymemory_t *memory, mymemory_marker_t marker)
+{
+    pool_lock(memory);
+    if (memory->strategy == ARENA && marker.top <= memory->arena_top) // Só marcas anteriores ao topo atual
+    {
+        memory->arena_top = marker.top;
+        memory->arena_last = marker.last;
+        memory->arena_count = marker.count;
+        regions_release_range(memory, marker.top, memory->total_size);  // Pool crescente: regiões acima do topo voltam ao sistema
+    }
+    pool_unlock(memory);
+}
+
+// Libera tudo de uma vez: O(1) na arena, proporcional aos blocos alocados nas demais estratégias
+// Nenhuma outra thread pode estar usando o pool durante o reset
+void mymemory_reset(mymemory_t *memory)
+{
+    if (memory->trace)
+    {
+        fprintf(memory->trace, "x\n");
+    }
+    if (memory->defer_queues) // Liberações ainda na fila se referem a blocos que deixam de existir: são descartadas
+    {
+        pthread_mutex_lock(&memory->defer_lock);
+        for (int slot = 0; slot < MYMEMORY_MAX_THREADS; slot++)
+        {
+            struct mymemory_defer_queue *queue = &memory->defer_queues[slot];
+            atomic_store_explicit(&queue->consumer.head, atomic_load_explicit(&queue->producer.tail, memory_order_acquire), memory_order_release);
+        }
+    }
+    pool_lock(memory);
+    if (memory->strategy == ARENA)
+    {
+        memory->arena_top = 0;
+        memory->arena_last = SIZE_MAX;
+        memory->arena_count = 0;
+    }
+    else if (memory->strategy == SLAB)
+    {
+        slab_init(memory);  // Todas as páginas voltam a ficar livres
+    }
+    else if (memory->strategy == BUDDY)
+    {
+        buddy_init(memory);  // Volta aos maiores blocos que cobrem o pool
+    }
+    else
+    {
+        reset_blocks(memory);
+        if (memory->concurrent) // Os blocos guardados nos caches de thread também deixam de existir
+        {
+            memset(memory->thread_caches, 0, MYMEMORY_MAX_THREADS * sizeof(*memory->thread_caches));
+        }
+        handles_reset(memory);  // Nenhum handle continua valendo
+    }
+    regions_release_range(memory, 0, memory->total_size);  // Pool crescente: tudo volta ao sistema (o tamanho atual continua)
+    pool_unlock(memory);
+    if (memory->defer_queues)
+    {
+        pthread_mutex_unlock(&memory->defer_lock);
+    }
+}
+
+// Estado do percurso em ordem de endereços: trechos livres vizinhos são entregues juntos, como um só
+struct extent_walk {
+    mymemory_extent_cb callback;
+    void *context;
+    mymemory_extent_t pending;  // Último trecho ainda não entregue (size 0 = nenhum)
+};
+
+// Acrescenta um trecho ao percurso; retorna o valor diferente de 0 com que o callback pediu para parar
+static int walk_emit(struct extent_walk *walk, char *start, size_t size, int is_free)
+{
+    if (walk->pending.size && walk->pending.is_free && is_free && (char *)walk->pending.start + walk->pending.size == start)
+    {
+        walk->pending.size += size;  // Continua o trecho livre anterior
+        return 0;
+    }
+    int stop = walk->pending.size ? walk->callback(&walk->pending, walk->context) : 0;
+    walk->pending.start = start;
+    walk->pending.size = size;
+    walk->pending.is_free = is_free;
+    return stop;
+}
+
+// Percorre o pool em ordem de endereços, chamando "callback" para cada trecho livre ou alocado, sem alocar memória
+// O pool fica travado durante o percurso: o callback não pode chamar funções do mymemory sobre o mesmo pool
+// Retorna 0 se percorreu tudo ou o valor diferente de 0 retornado pelo callback que interrompeu o percurso
+int mymemory_walk(mymemory_t *memory, mymemory_extent_cb callback, void *context)
+{
+    struct extent_walk walk = { callback, context, { NULL, 0, 0 } };
+    char *pool = (char *)memory->pool;
+    size_t covered = 0;  // Bytes do pool já entregues ao percurso
+    int stop = 0;
+
+    pool_lock(memory);
+    switch (memory->strategy)
+    {
+        case FIRST_FIT:
+        case BEST_FIT:
+        case WORST_FIT:
+        case SEGREGATED_FIT:
+            for (allocation_t *block = memory->head; block && !stop; block = block->phys_next) // O encadeamento físico já está em ordem
+            {
+                stop = walk_emit(&walk, (char *)block->start, block->size, block->is_free);
+                covered += block->size;
+            }
+            break;
+
+        case ARENA: // Tudo abaixo do topo está em uso
+            if (memory->arena_top)
+            {
+                stop = walk_emit(&walk, pool, memory->arena_top, 0);
+                covered = memory->arena_top;
+            }
+            break;
+
+        case SLAB:
+            for (size_t i = 0; i < memory->slab_page_count && !stop; i++)
+            {
+                struct mymemory_slab_page *page = &memory->slab_pages[i];
+                char *start = pool + i * MYMEMORY_SLAB_PAGE;
+                if (page->kind == SLAB_PAGE_OBJECTS) // Uma posição por vez: os objetos em uso aparecem individualmente
+                {
+                    size_t object_size = slab_class_size(page->cls);
+                    for (size_t slot = 0; slot < MYMEMORY_SLAB_PAGE / object_size && !stop; slot++)
+                    {
+                        int slot_free = (int)((page->free_slots[slot / 64] >> (slot % 64)) & 1);
+                        stop = walk_emit(&walk, start + slot * object_size, object_size, slot_free);
+                    }
+                }
+                else if (page->kind != SLAB_PAGE_LARGE_TAIL) // As demais páginas de um objeto grande já vieram com a primeira
+                {
+                    size_t size = page->kind == SLAB_PAGE_LARGE ? (size_t)page->run * MYMEMORY_SLAB_PAGE : MYMEMORY_SLAB_PAGE;
+                    stop = walk_emit(&walk, start, size, page->kind == SLAB_PAGE_FREE);
+                }
+            }
+            covered = memory->slab_page_count * MYMEMORY_SLAB_PAGE;
+            break;
+
+        case BUDDY:
+            while (covered + MYMEMORY_GRANULE <= memory->total_size && !stop)
+            {
+                int is_free;
+                size_t size = buddy_extent(memory, covered, &is_free);
+                stop = walk_emit(&walk, pool + covered, size, is_free);
+                covered += size;
+            }
+            break;
+    }
+    if (!stop && covered < memory->total_size) // Final do pool que a estratégia não usa (ou livre acima do topo da arena)
+    {
+        stop = walk_emit(&walk, pool + covered, memory->total_size - covered, 1);
+    }
+    if (!stop && walk.pending.size)
+    {
+        stop = callback(&walk.pending, context);
+    }
+    pool_unlock(memory);
+    return stop;
+}
+
+// Destino de um snapshot
+struct snapshot_output {
+    FILE *out;
+    char *pool;  // Os trechos são gravados como deslocamentos a partir do início do pool
+    size_t count;  // Trechos já gravados
+};
+
+// Um trecho em JSON: um objeto por linha, para comparar snapshots com diff
+static int snapshot_json_extent(const mymemory_extent_t *extent, void *context)
+{
+    struct snapshot_output *output = (struct snapshot_output *)context;
+    fprintf(output->out, "%s{\"offset\":%lu,\"size\":%lu,\"free\":%d}", output->count++ ? ",\n" : "\n",
+            (unsigned long)((char *)extent->start - output->pool), (unsigned long)extent->size, extent->is_free);
+    return ferror(output->out);
+}
+
+// Um trecho em CSV
+static int snapshot_csv_extent(const mymemory_extent_t *extent, void *context)
+{
+    struct snapshot_output *output = (struct snapshot_output *)context;
+    fprintf(output->out, "%lu,%lu,%d\n", (unsigned long)((char *)extent->start - output->pool), (unsigned long)extent->size, extent->is_free);
+    output->count++;
+    return ferror(output->out);
+}
+
+// Um trecho em binário: deslocamento e tamanho em 64 bits; o bit 0 do tamanho indica trecho livre
+static int snapshot_binary_extent(const mymemory_extent_t *extent, void *context)
+{
+    struct snapshot_output *output = (struct snapshot_output *)context;
+    uint64_t record[2] = { (uint64_t)((char *)extent->start - output->pool), (uint64_t)extent->size << 1 | (uint64_t)(extent->is_free != 0) };
+    output->count++;
+    return fwrite(record, sizeof(record), 1, output->out) != 1;
+}
+
+// Grava em "out" um snapshot do pool em ordem de endereços, trecho a trecho, sem alocar memória
+// Retorna 0 em caso de sucesso e -1 se o formato for inválido ou a escrita falhar
+int mymemory_snapshot(mymemory_t *memory, FILE *out, mymemory_snapshot_format_t format)
+{
+    struct snapshot_output output = { out, (char *)memory->pool, 0 };
+    int failed;
+
+    switch (format)
+    {
+        case MYMEMORY_SNAPSHOT_JSON:
+            fprintf(out, "{\"strategy\":\"%s\",\"total_size\":%lu,\"extents\":[", strategy_name(memory->strategy), (unsigned long)memory->total_size);
+            failed = mymemory_walk(memory, snapshot_json_extent, &output);
+            fprintf(out, "\n]}\n");
+            break;
+
+        case MYMEMORY_SNAPSHOT_CSV:
+            fprintf(out, "offset,size,free\n");
+            failed = mymemory_walk(memory, snapshot_csv_extent, &output);
+            break;
+
+        case MYMEMORY_SNAPSHOT_BINARY: // Cabeçalho: "MYMS", versão, estratégia e tamanho do pool; depois os registros
+        {
+            uint32_t header[2] = { 0x534D594D, 1 };  // "MYMS" na ordem de bytes little-endian, versão 1
+            uint64_t pool_info[2] = { (uint64_t)memory->strategy, (uint64_t)memory->total_size };
+            failed = fwrite(header, sizeof(header), 1, out) != 1 || fwrite(pool_info, sizeof(pool_info), 1, out) != 1;
+            if (!failed)
+            {
+                failed = mymemory_walk(memory, snapshot_binary_extent, &output);
+            }
+            break;
+        }
+
+        default:
+            return -1;
+    }
+    return failed || ferror(out) ? -1 : 0;
+}
+
+// Linha da tabela de layout para um trecho
+static int print_layout_extent(const mymemory_extent_t *extent, void *context)
+{
+    (void)context;
+    printf("| 0x%-18p | 0x%-18p | %8lu | %-7s |\n", extent->start, (char *)extent->start + extent->size - 1,
+           (unsigned long)extent->size, extent->is_free ? "Livre" : "Alocado");
+    printf("+----------------------+----------------------+----------+---------+\n");
+    return 0;
+}
+
+// Função auxiliar para imprimir o estado atual da memória em ordem de endereços
+void print_memory_layout(mymemory_t *memory) 
+{
+    printf("\nEstado atual da memoria:\n");
+    printf("+----------------------+----------------------+----------+---------+\n");
+    printf("| Inicio               | Fim                  | Tamanho  | Estado  |\n");
+    printf("+----------------------+----------------------+----------+---------+\n");
+    mymemory_walk(memory, print_layout_extent, NULL);
+}
+
+// Exibe alocações atuais
+void mymemory_display(mymemory_t *memory) 
+{
+    pool_lock(memory);
+    allocation_t *current = memory->allocated_blocks; // Ponteiro para iterar sobre os blocos alocados (inclui os guardados nos caches de thread)
+    printf("Alocacoes atuais:\n");
+    if (memory->strategy == ARENA) // A arena não guarda os objetos individualmente
+    {
+        printf("Arena: %lu objetos, topo em 0x%p (%lu bytes usados)\n", (unsigned long)memory->arena_count,
+               (char *)memory->pool + memory->arena_top, (unsigned long)memory->arena_top);
+    }
+    for (size_t i = 0; memory->strategy == SLAB && i < memory->slab_page_count; i++) // Slab: uma linha por página em uso
+    {
+        struct mymemory_slab_page *page = &memory->slab_pages[i];
+        char *start = (char *)memory->pool + i * MYMEMORY_SLAB_PAGE;
+        if (page->kind == SLAB_PAGE_OBJECTS)
+        {
+            printf("Pagina: 0x%p, Objetos de %lu bytes: %u de %lu\n", (void *)start, (unsigned long)slab_class_size(page->cls),
+                   (unsigned)page->used, (unsigned long)(MYMEMORY_SLAB_PAGE / slab_class_size(page->cls)));
+        }
+        else if (page->kind == SLAB_PAGE_LARGE)
+        {
+            printf("Inicio: 0x%p, Tamanho: %lu\n", (void *)start, (unsigned long)page->run * MYMEMORY_SLAB_PAGE);
+        }
+    }
+
+    for (size_t offset = 0; memory->strategy == BUDDY && offset + MYMEMORY_GRANULE <= memory->total_size;) // Buddy: blocos alocados em ordem de endereços
+    {
+        int is_free;
+        size_t extent = buddy_extent(memory, offset, &is_free);
+        if (!is_free)
+        {
+            printf("Inicio: 0x%p, Tamanho: %lu\n", (void *)((char *)memory->pool + offset), (unsigned long)extent);
+        }
+        offset += extent;
+    }
+
+    while (current) // Percorre a lista de blocos alocados
+    { 
+        printf("Inicio: 0x%p, Tamanho: %lu\n", current->start, (unsigned long)current->size); // Imprime endereço e tamanho
+        current = current->next; // Avança para o próximo bloco
+    }
+    pool_unlock(memory);
+}
+
+// Recalcula o maior trecho livre, que pode ter diminuído desde a última consulta
+static void refresh_largest_free(mymemory_t *memory)
+{
+    size_t largest = 0;
+
+    switch (memory->strategy)
+    {
+        case BEST_FIT:
+        case WORST_FIT:
+            largest = size_tree_largest(memory);  // Última chave da árvore por tamanho
+            break;
+
+        case FIRST_FIT:
+            for (allocation_t *block = memory->free_blocks; block; block = block->next) // Blocos livres vizinhos sempre são fundidos
+            {
+                if (block->size > largest)
+                {
+                    largest = block->size;
+                }
+            }
+            break;
+
+        case SEGREGATED_FIT:
+            if (memory->fl_bitmap) // Só a lista da maior subclasse não vazia precisa ser percorrida
+            {
+                int fl = 63 - __builtin_clzll(memory->fl_bitmap);
+                int sl = 31 - __builtin_clz(memory->sl_bitmap[fl]);
+                for (allocation_t *block = memory->segregated[fl][sl]; block; block = block->next)
+                {
+                    if (block->size > largest)
+                    {
+                        largest = block->size;
+                    }
+                }
+            }
+            break;
+
+        case ARENA:
+            largest = memory->total_size - memory->arena_top;
+            break;
+
+        case SLAB:
+            largest = (size_t)memory->slab_runs[1].best * MYMEMORY_SLAB_PAGE;  // Raiz da árvore de sequências livres
+            break;
+
+        case BUDDY:
+            if (memory->buddy_nonempty) // Maior ordem com bloco livre
+            {
+                largest = buddy_block_size(63 - __builtin_clzll(memory->buddy_nonempty));
+            }
+            break;
+    }
+    memory->counters.largest_free_block = largest;
+    memory->largest_free_dirty = 0;
+}
+
+// Estatísticas atuais do pool, em O(1): os contadores são mantidos a cada operação
+// Só o maior trecho livre é recalculado, e apenas quando uma alocação pode tê-lo diminuído
+mymemory_stats_t mymemory_get_stats(mymemory_t *memory)
+{
+    pool_lock(memory);
+    if (memory->largest_free_dirty || memory->strategy == ARENA)
+    {
+        refresh_largest_free(memory);
+    }
+    mymemory_stats_t stats = memory->counters;
+    if (memory->strategy == ARENA) // Arena: uma área usada abaixo do topo e uma livre acima dele
+    {
+        stats.bytes_in_use = memory->arena_top;
+        stats.allocated_blocks = memory->arena_count;
+        stats.free_blocks = memory->arena_top < memory->total_size;
+    }
+    if (memory->strategy == BUDDY) // Arredondamento para potência de 2
+    {
+        stats.internal_fragmentation = stats.bytes_in_use - memory->buddy_requested;
+    }
+    stats.resident_size = memory->total_size;
+    if (memory->region_size) // Pool crescente: só as regiões tocadas desde a última devolução ao sistema
+    {
+        size_t resident = 0;
+        for (size_t word = 0; word < (memory->max_size / memory->region_size + 63) / 64; word++)
+        {
+            resident += (size_t)__builtin_popcountll(memory->region_resident[word]);
+        }
+        stats.resident_size = resident * memory->region_size;
+    }
+    pool_unlock(memory);
+
+    stats.total_size = memory->total_size;
+    stats.bytes_free = memory->total_size - stats.bytes_in_use;
+    for (int slot = 0; memory->defer_queues && slot < MYMEMORY_MAX_THREADS; slot++) // Os blocos pendentes ainda contam como em uso
+    {
+        struct mymemory_defer_queue *queue = &memory->defer_queues[slot];
+        stats.pending_frees += atomic_load_explicit(&queue->producer.tail, memory_order_acquire) - atomic_load_explicit(&queue->consumer.head, memory_order_acquire);
+    }
+    return stats;
+}
+
+// Exibe estatísticas de memória
+void mymemory_stats(mymemory_t *memory) 
+{
+    mymemory_stats_t stats = mymemory_get_stats(memory);
+
+    // Exibe estatísticas de memória
+    printf("Estatisticas de memoria:\n");
+    printf("Total de alocacoes: %lu\n", (unsigned long)stats.allocated_blocks);
+    printf("Memoria total alocada: %lu bytes\n", (unsigned long)stats.bytes_in_use);
+    printf("Pico de memoria alocada: %lu bytes\n", (unsigned long)stats.peak_bytes_in_use);
+    printf("Memoria total livre: %lu bytes\n", (unsigned long)stats.bytes_free);
+    printf("Maior bloco livre contiguo: %lu bytes\n", (unsigned long)stats.largest_free_block);
+    printf("Numero de fragmentos de memoria livre: %lu\n", (unsigned long)stats.free_blocks);
+    printf("Alocacoes que falharam: %lu\n", (unsigned long)stats.failed_allocations);
+    if (memory->harden)
+    {
+        printf("Modo de depuracao: %lu erros detectados, %lu blocos na quarentena\n", (unsigned long)stats.guard_errors,
+               (unsigned long)memory->quarantine_count);
+    }
+    if (memory->defer_queues)
+    {
+        printf("Liberacoes adiadas pendentes: %lu\n", (unsigned long)stats.pending_frees);
+    }
+    if (memory->region_size)
+    {
+        printf("Pool crescente: %lu de %lu bytes mapeados, %lu bytes residentes\n", (unsigned long)stats.total_size,
+               (unsigned long)memory->max_size, (unsigned long)stats.resident_size);
+    }
+    if (memory->strategy == BUDDY)
+    {
+        printf("Fragmentacao interna: %lu bytes (%.1f%% da memoria alocada)\n", (unsigned long)stats.internal_fragmentation,
+               stats.bytes_in_use ? 100.0 * (double)stats.internal_fragmentation / (double)stats.bytes_in_use : 0.0);
+    }
+#ifdef MYMEMORY_INSTRUMENT
+    mymemory_instrument_dump(memory, stdout); // Compilado com instrumentação: latências e buscas junto das estatísticas
+#endif
+}
+
+#ifdef MYMEMORY_INSTRUMENT
+// Percentil "fraction" (0 a 1) de um histograma logarítmico: limite superior da faixa que o contém
+static uint64_t instrument_percentile(const uint64_t *histogram, uint64_t total, double fraction)
+{
+    uint64_t seen = 0;
+    for (unsigned bucket = 0; bucket < MYMEMORY_INSTRUMENT_BUCKETS; bucket++)
+    {
+        seen += histogram[bucket];
+        if (seen && (double)seen >= fraction * (double)total)
+        {
+            return bucket ? (1ULL << bucket) - 1 : 0;  // A faixa "bucket" vai de 2^(bucket-1) a 2^bucket - 1
+        }
+    }
+    return 0;
+}
+
+// Imprime um histograma logarítmico, uma linha por faixa não vazia
+static void instrument_print_histogram(FILE *out, const char *title, const uint64_t *histogram)
+{
+    fprintf(out, "%s:\n", title);
+    for (unsigned bucket = 0; bucket < MYMEMORY_INSTRUMENT_BUCKETS; bucket++)
+    {
+        if (histogram[bucket])
+        {
+            fprintf(out, "  %10llu - %-10llu %llu\n", bucket ? 1ULL << (bucket - 1) : 0ULL, bucket ? (1ULL << bucket) - 1 : 0ULL,
+                    (unsigned long long)histogram[bucket]);
+        }
+    }
+}
+#endif
+
+// Exibe a instrumentação somada de todas as threads: contagens e latências por classe de tamanho e comprimentos de busca
+void mymemory_instrument_dump(mymemory_t *memory, FILE *out)
+{
+#ifdef MYMEMORY_INSTRUMENT
+    uint64_t alloc[MYMEMORY_INSTRUMENT_CLASSES][MYMEMORY_INSTRUMENT_BUCKETS] = { { 0 } };  // Somas de todas as threads
+    uint64_t release[MYMEMORY_INSTRUMENT_CLASSES][MYMEMORY_INSTRUMENT_BUCKETS] = { { 0 } };
+    uint64_t alloc_search[MYMEMORY_INSTRUMENT_BUCKETS] = { 0 };
+    uint64_t free_search[MYMEMORY_INSTRUMENT_BUCKETS] = { 0 };
+
+    for (int slot = 0; slot < MYMEMORY_MAX_THREADS; slot++)
+    {
+        struct mymemory_instrument *local = &memory->instrument[slot];
+        for (unsigned bucket = 0; bucket < MYMEMORY_INSTRUMENT_BUCKETS; bucket++)
+        {
+            for (unsigned cls = 0; cls < MYMEMORY_INSTRUMENT_CLASSES; cls++)
+            {
+                alloc[cls][bucket] += atomic_load_explicit(&local->alloc[cls][bucket], memory_order_relaxed);
+                release[cls][bucket] += atomic_load_explicit(&local->free[cls][bucket], memory_order_relaxed);
+            }
+            alloc_search[bucket] += atomic_load_explicit(&local->alloc_search[bucket], memory_order_relaxed);
+            free_search[bucket] += atomic_load_explicit(&local->free_search[bucket], memory_order_relaxed);
+        }
+    }
+
+    fprintf(out, "Instrumentacao (%s):\n", strategy_name(memory->strategy));
+    fprintf(out, "%12s %12s %10s %10s %12s %10s %10s\n", "classe", "alocacoes", "p50 ns", "p99 ns", "liberacoes", "p50 ns", "p99 ns");
+    for (unsigned cls = 0; cls < MYMEMORY_INSTRUMENT_CLASSES; cls++)
+    {
+        uint64_t allocs = 0, frees = 0;
+        for (unsigned bucket = 0; bucket < MYMEMORY_INSTRUMENT_BUCKETS; bucket++)
+        {
+            allocs += alloc[cls][bucket];
+            frees += release[cls][bucket];
+        }
+        if (!allocs && !frees)
+        {
+            continue;  // Classe nunca usada
+        }
+        char label[32];
+        snprintf(label, sizeof(label), cls + 1 < MYMEMORY_INSTRUMENT_CLASSES ? "<= %lu" : "> %lu",
+                 (unsigned long)MYMEMORY_GRANULE << (cls + 1 < MYMEMORY_INSTRUMENT_CLASSES ? cls : cls - 1));
+        fprintf(out, "%12s %12llu %10llu %10llu %12llu %10llu %10llu\n", label,
+                (unsigned long long)allocs, (unsigned long long)instrument_percentile(alloc[cls], allocs, 0.5),
+                (unsigned long long)instrument_percentile(alloc[cls], allocs, 0.99),
+                (unsigned long long)frees, (unsigned long long)instrument_percentile(release[cls], frees, 0.5),
+                (unsigned long long)instrument_percentile(release[cls], frees, 0.99));
+    }
+    instrument_print_histogram(out, "Blocos livres examinados por alocacao", alloc_search);
+    instrument_print_histogram(out, "Blocos livres percorridos por insercao na liberacao", free_search);
+#else
+    (void)memory;
+    fprintf(out, "Instrumentacao desativada (compile com -DMYMEMORY_INSTRUMENT).\n");
+#endif
+}
+
+// Cabeçalho do arquivo de um pool persistente; logo depois dele fica o próprio mymemory_t
+struct mymemory_file_header {
+    char magic[8];  // MYMEMORY_FILE_MAGIC
+    uint32_t version;  // Versão do formato
+    uint32_t state_size;  // sizeof(mymemory_t) de quem criou o arquivo
+    uint64_t file_size;  // Tamanho total do arquivo
+    uint64_t base;  // Endereço do mapeamento ao qual os ponteiros guardados no arquivo se referem
+};
+
+#define MYMEMORY_FILE_MAGIC "MYMEMPST"
+#define MYMEMORY_FILE_VERSION 7  // 2: allocation_t com o campo "handle"; 3: campos da árvore por tamanho em mymemory_t; 4: modo de depuração; 5: filas de liberações adiadas em mymemory_t; 6: inícios dos objetos da arena; 7: maior topo da arena
+#define MYMEMORY_FILE_STATE 64  // Posição do mymemory_t no arquivo (depois do cabeçalho)
+
+// Posições das tabelas da estratégia e do pool dentro do arquivo
+typedef struct {
+    size_t table;  // Descritores (First/Best/Worst/Segregated Fit), páginas (Slab) ou bitmaps (Buddy)
+    size_t table2;  // Índice, bitmap de páginas livres (Slab) ou ordens por grânulo (Buddy)
+    size_t pool;  // Início do pool
+    size_t file_size;  // Tamanho total do arquivo
+} persist_layout_t;
+
+// Calcula onde cada tabela fica no arquivo de um pool de "size" bytes com a estratégia dada
+static persist_layout_t persist_layout(size_t size, AllocationStrategy strategy)
+{
+    persist_layout_t layout;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t table_size = 0, table2_size = 0;
+
+    if (strategy == SLAB)
+    {
+        table_size = (size / MYMEMORY_SLAB_PAGE + 1) * sizeof(struct mymemory_slab_page);
+        table2_size = (size / MYMEMORY_SLAB_PAGE / 64 + 1) * sizeof(uint64_t);
+    }
+    else if (strategy == BUDDY)
+    {
+        size_t granules = size / MYMEMORY_GRANULE;
+        for (int order = 0; order < MYMEMORY_BUDDY_ORDERS; order++) // Mesma conta do buddy_init
+        {
+            table_size += ((granules >> order) / 64 + 1) * sizeof(uint64_t);
+        }
+        table2_size = granules + 1;
+    }
+    else if (strategy == ARENA)
+    {
+        table_size = (size / MYMEMORY_GRANULE / 64 + 1) * sizeof(uint64_t);
+    }
+    else
+    {
+        table_size = (size / MYMEMORY_GRANULE + 1) * sizeof(allocation_t);
+        table2_size = (size / MYMEMORY_GRANULE + 1) * sizeof(allocation_t *);
+    }
+    layout.table = (MYMEMORY_FILE_STATE + sizeof(mymemory_t) + 63) & ~(size_t)63;
+    layout.table2 = (layout.table + table_size + 63) & ~(size_t)63;
+    layout.pool = (layout.table2 + table2_size + page - 1) / page * page;  // Pool alinhado a página (Slab e Buddy exigem)
+    layout.file_size = layout.pool + size;
+    return layout;
+}
+
+// Aponta as tabelas da estratégia e o pool para dentro do mapeamento
+static void persist_place(mymemory_t *memory, char *mapping, const persist_layout_t *layout)
+{
+    memory->pool = mapping + layout->pool;
+    memory->descriptors = NULL;
+    memory->index_slots = NULL;
+    memory->slab_pages = NULL;
+    memory->slab_free_map = NULL;
+    memory->buddy_map = NULL;
+    memory->buddy_order = NULL;
+    memory->arena_starts = NULL;
+    if (memory->strategy == ARENA)
+    {
+        memory->arena_starts = (uint64_t *)(mapping + layout->table);
+    }
+    else if (memory->strategy == SLAB)
+    {
+        memory->slab_pages = (struct mymemory_slab_page *)(mapping + layout->table);
+        memory->slab_free_map = (uint64_t *)(mapping + layout->table2);
+    }
+    else if (memory->strategy == BUDDY)
+    {
+        memory->buddy_map = (uint64_t *)(mapping + layout->table);
+        memory->buddy_order = (uint8_t *)(mapping + layout->table2);
+    }
+    else if (memory->strategy != ARENA)
+    {
+        memory->descriptors = (allocation_t *)(mapping + layout->table);
+        memory->index_slots = (allocation_t **)(mapping + layout->table2);
+    }
+}
+
+// Desloca um ponteiro guardado no arquivo para o mapeamento atual (NULL continua NULL)
+static void *persist_rebase(void *ptr, intptr_t delta)
+{
+    return ptr ? (char *)ptr + delta : NULL;
+}
+
+// Corrige todos os ponteiros internos quando o arquivo foi mapeado em outro endereço
+// Só as estratégias com descritores guardam ponteiros; Slab e Buddy usam posições relativas
+static void persist_relocate(mymemory_t *memory, intptr_t delta)
+{
+    memory->free_blocks = persist_rebase(memory->free_blocks, delta);
+    memory->allocated_blocks = persist_rebase(memory->allocated_blocks, delta);
+    memory->head = persist_rebase(memory->head, delta);
+    memory->free_descriptors = persist_rebase(memory->free_descriptors, delta);
+    for (int fl = 0; fl < MYMEMORY_FL_COUNT; fl++)
+    {
+        for (int sl = 0; sl < MYMEMORY_SL_COUNT; sl++)
+        {
+            memory->segregated[fl][sl] = persist_rebase(memory->segregated[fl][sl], delta);
+        }
+    }
+    for (size_t i = 0; i < memory->descriptors_used; i++) // Entradas nunca tocadas não têm ponteiros
+    {
+        allocation_t *block = &memory->descriptors[i];
+        block->start = persist_rebase(block->start, delta);
+        block->next = persist_rebase(block->next, delta);
+        block->prev = persist_rebase(block->prev, delta);
+        block->phys_prev = persist_rebase(block->phys_prev, delta);
+        block->phys_next = persist_rebase(block->phys_next, delta);
+    }
+    for (size_t i = 0; i < memory->index_capacity; i++)
+    {
+        memory->index_slots[i] = persist_rebase(memory->index_slots[i], delta);
+    }
+}
+
+// Indica se "block" é uma entrada já usada do slab de descritores
+static int persist_valid_descriptor(mymemory_t *memory, allocation_t *block)
+{
+    return block >= memory->descriptors && block < memory->descriptors + memory->descriptors_used &&
+           (size_t)((char *)block - (char *)memory->descriptors) % sizeof(allocation_t) == 0;
+}
+
+// Confere uma lista de blocos livres ou alocados: entradas válidas, estado esperado e encadeamento "prev" coerente
+static int persist_check_list(mymemory_t *memory, allocation_t *list, int is_free, size_t *count)
+{
+    allocation_t *prev = NULL;
+    for (allocation_t *block = list; block; prev = block, block = block->next)
+    {
+        if (!persist_valid_descriptor(memory, block) || block->is_free != is_free || block->prev != prev || ++*count > memory->descriptors_used)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Consistência das estratégias com descritores: blocos cobrem o pool em ordem, listas e índice batem com eles
+static int persist_check_blocks(mymemory_t *memory)
+{
+    size_t offset = 0, blocks = 0, allocated = 0, free_blocks = 0, in_use = 0;
+    allocation_t *prev = NULL;
+
+    if (memory->descriptors_used > memory->descriptor_capacity || memory->index_capacity != memory->descriptor_capacity)
+    {
+        return 0;
+    }
+    for (allocation_t *block = memory->head; block; prev = block, block = block->phys_next)
+    {
+        if (!persist_valid_descriptor(memory, block) || block->phys_prev != prev || ++blocks > memory->descriptors_used ||
+            block->start != (char *)memory->pool + offset || !block->size || block->size > memory->total_size - offset ||
+            (block->is_free && prev && prev->is_free))
+        {
+            return 0;  // Fora do slab, fora de ordem, fora do pool ou dois livres vizinhos
+        }
+        if (block->is_free)
+        {
+            free_blocks++;
+        }
+        else
+        {
+            allocated++;
+            in_use += block->size;
+            if (memory->index_slots[index_slot(memory, block->start)] != block)
+            {
+                return 0;  // Bloco alocado fora do índice
+            }
+        }
+        offset += block->size;
+    }
+    if (offset != memory->total_size || allocated != memory->index_count || allocated != memory->counters.allocated_blocks ||
+        in_use != memory->counters.bytes_in_use || free_blocks != memory->counters.free_blocks)
+    {
+        return 0;
+    }
+
+    size_t listed = 0, listed_free = 0;
+    if (!persist_check_list(memory, memory->allocated_blocks, 0, &listed) || listed != allocated)
+    {
+        return 0;
+    }
+    if (memory->strategy == SEGREGATED_FIT)
+    {
+        for (int fl = 0; fl < MYMEMORY_FL_COUNT; fl++)
+        {
+            for (int sl = 0; sl < MYMEMORY_SL_COUNT; sl++)
+            {
+                if (!persist_check_list(memory, memory->segregated[fl][sl], 1, &listed_free))
+                {
+                    return 0;
+                }
+            }
+        }
+    }
+    else if (!persist_check_list(memory, memory->free_blocks, 1, &listed_free))
+    {
+        return 0;
+    }
+    return listed_free == free_blocks;
+}
+
+// Consistência do Slab: tipos de página, sequências de objetos grandes e bitmap de páginas livres
+static int persist_check_slab(mymemory_t *memory)
+{
+    size_t in_use = 0, objects = 0;
+
+    if (memory->slab_page_count != memory->total_size / MYMEMORY_SLAB_PAGE)
+    {
+        return 0;
+    }
+    for (size_t i = 0; i < memory->slab_page_count; i++)
+    {
+        struct mymemory_slab_page *page = &memory->slab_pages[i];
+        int marked_free = (memory->slab_free_map[i / 64] >> (i % 64)) & 1;
+        if (marked_free != (page->kind == SLAB_PAGE_FREE) || page->kind > SLAB_PAGE_LARGE_TAIL)
+        {
+            return 0;
+        }
+        if (page->kind == SLAB_PAGE_OBJECTS)
+        {
+            if (page->cls >= MYMEMORY_SLAB_CLASSES || page->used > MYMEMORY_SLAB_PAGE / slab_class_size(page->cls))
+            {
+                return 0;
+            }
+            objects += page->used;
+            in_use += page->used * slab_class_size(page->cls);
+        }
+        else if (page->kind == SLAB_PAGE_LARGE)
+        {
+            if (!page->run || page->run > memory->slab_page_count - i)
+            {
+                return 0;
+            }
+            for (size_t tail = i + 1; tail < i + page->run; tail++)
+            {
+                if (memory->slab_pages[tail].kind != SLAB_PAGE_LARGE_TAIL)
+                {
+                    return 0;
+                }
+            }
+            objects++;
+            in_use += (size_t)page->run * MYMEMORY_SLAB_PAGE;
+        }
+    }
+    for (int cls = 0; cls < MYMEMORY_SLAB_CLASSES; cls++) // Listas de páginas parciais: só páginas da classe, sem ciclos
+    {
+        int32_t prev = -1;
+        size_t listed = 0;
+        for (int32_t index = memory->slab_partial[cls]; index >= 0; prev = index, index = memory->slab_pages[index].next_partial)
+        {
+            if ((size_t)index >= memory->slab_page_count || memory->slab_pages[index].kind != SLAB_PAGE_OBJECTS ||
+                memory->slab_pages[index].cls != cls || memory->slab_pages[index].prev_partial != prev || ++listed > memory->slab_page_count)
+            {
+                return 0;
+            }
+        }
+    }
+    return objects == memory->counters.allocated_blocks && in_use == memory->counters.bytes_in_use;
+}
+
+// Consistência do Buddy: blocos alocados e livres cobrem o pool, cada um alinhado ao próprio tamanho
+static int persist_check_buddy(mymemory_t *memory)
+{
+    size_t limit = memory->total_size / MYMEMORY_GRANULE * MYMEMORY_GRANULE;
+    size_t in_use = 0, allocated = 0, words = 0, free_extents = 0, listed = 0;
+
+    for (int order = 0; order < MYMEMORY_BUDDY_ORDERS; order++) // Bitmaps de cada ordem onde o buddy_init os colocou
+    {
+        if (memory->buddy_map_offset[order] != words)
+        {
+            return 0;
+        }
+        words += ((limit / MYMEMORY_GRANULE) >> order) / 64 + 1;
+    }
+    for (size_t offset = 0; offset < limit;)
+    {
+        uint8_t order = memory->buddy_order[offset / MYMEMORY_GRANULE];
+        if (order != BUDDY_ORDER_NONE && (order & ~BUDDY_ORDER_EXACT) >= MYMEMORY_BUDDY_ORDERS)
+        {
+            return 0;
+        }
+        int is_free;
+        size_t extent = buddy_extent(memory, offset, &is_free);
+        if ((offset & (extent - 1)) || extent > limit - offset || (is_free && !buddy_is_free(memory, (int)__builtin_ctzll(extent / MYMEMORY_GRANULE), offset)))
+        {
+            return 0;  // Bloco desalinhado, além do pool, ou grânulo que não pertence a nenhum bloco
+        }
+        if (!is_free)
+        {
+            allocated++;
+            in_use += extent;
+        }
+        free_extents += is_free;
+        offset += extent;
+    }
+    for (int order = 0; order < MYMEMORY_BUDDY_ORDERS; order++) // Listas de livres: blocos marcados no bitmap, sem ciclos
+    {
+        size_t prev = SIZE_MAX;
+        for (size_t offset = memory->buddy_free[order]; offset != SIZE_MAX; prev = offset, offset = buddy_link(memory, offset)->next)
+        {
+            if (offset >= limit || buddy_block_size(order) > limit - offset || (offset & (buddy_block_size(order) - 1)) ||
+                !buddy_is_free(memory, order, offset) || buddy_link(memory, offset)->prev != prev || ++listed > free_extents)
+            {
+                return 0;
+            }
+        }
+        if (((memory->buddy_nonempty >> order) & 1) != (memory->buddy_free[order] != SIZE_MAX))
+        {
+            return 0;
+        }
+    }
+    return listed == free_extents && allocated == memory->counters.allocated_blocks && in_use == memory->counters.bytes_in_use &&
+           memory->buddy_requested <= in_use;
+}
+
+// Confere se o estado do pool guardado no arquivo é coerente antes de usá-lo
+static int persist_check(mymemory_t *memory)
+{
+    if (memory->alignment < MYMEMORY_GRANULE || (memory->alignment & (memory->alignment - 1)) ||
+        memory->alignment != 1ULL << memory->alignment_shift || memory->max_size != memory->total_size)
+    {
+        return 0;
+    }
+    switch (memory->strategy)
+    {
+        case ARENA:
+            return memory->arena_top <= memory->total_size &&
+                   (memory->arena_last == SIZE_MAX || (memory->arena_last < memory->arena_top && arena_is_start(memory, memory->arena_last)));
+
+        case SLAB:
+            return persist_check_slab(memory);
+
+        case BUDDY:
+            return persist_check_buddy(memory);
+
+        case FIRST_FIT:
+        case BEST_FIT:
+        case WORST_FIT:
+        case SEGREGATED_FIT:
+            return persist_check_blocks(memory);
+    }
+    return 0;  // Estratégia desconhecida
+}
+
+// Prepara os campos que só valem durante a execução (lock, caches, trace, instrumentação); retorna 0 sem memória para os contadores
+static int persist_runtime(mymemory_t *memory, char *mapping, size_t file_size)
+{
+    memory->mapping = mapping;
+    memory->mapping_size = file_size;
+    memory->concurrent = 0;
+    memory->verbose = 0;
+    memory->thread_caches = NULL;
+    memory->defer_queues = NULL;  // Sem thread de manutenção: as liberações são síncronas
+    memory->trace = NULL;
+    memory->region_size = 0;
+    memory->region_resident = NULL;
+    memory->region_hugetlb = 0;
+    memory->instrument = NULL;
+    memory->handles = NULL;  // Handles não sobrevivem ao processo (mymemory_halloc recusa pools persistentes)
+    memory->handle_capacity = 0;
+    memory->handle_free = 0;
+    memory->compact_cursor = SIZE_MAX;
+    memory->harden = 0;  // O modo de depuração é escolhido no mymemory_init_config, que pools persistentes não usam
+    memory->quarantine = NULL;
+    memory->quarantine_head = 0;
+    memory->quarantine_count = 0;
+    memory->size_nodes = NULL;  // A árvore por tamanho fica fora do arquivo: pool_setup ou mymemory_open a refazem
+    memory->size_node_capacity = 0;
+    memory->size_nodes_used = 0;
+    memory->size_free_nodes = NULL;
+    memory->size_root = NULL;
+    memory->slab_runs = NULL;  // A árvore de sequências livres do Slab também fica fora do arquivo
+    memory->slab_run_leaves = 0;
+#ifdef MYMEMORY_INSTRUMENT
+    if (posix_memalign((void **)&memory->instrument, 64, MYMEMORY_MAX_THREADS * sizeof(*memory->instrument)) != 0) // Contadores por slot de thread
+    {
+        memory->instrument = NULL;
+        return 0;
+    }
+    memset(memory->instrument, 0, MYMEMORY_MAX_THREADS * sizeof(*memory->instrument));
+#endif
+    ((struct mymemory_file_header *)mapping)->base = (uint64_t)(uintptr_t)mapping;  // Os ponteiros internos agora se referem a este endereço
+    return 1;
+}
+
+// Abre um pool persistente guardado em "path": cria o arquivo se ele não existe ou está vazio,
+// senão mapeia o pool existente (mesmo tamanho e estratégia), corrige os ponteiros e confere a consistência
+mymemory_t* mymemory_open(const char *path, size_t size, AllocationStrategy strategy)
+{
+    persist_layout_t layout = persist_layout(size, strategy);
+    struct mymemory_file_header header;
+    struct stat info;
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    int existing = info.st_size > 0;
+    void *hint = NULL;  // Endereço em que os ponteiros do arquivo continuam válidos
+    if (existing)
+    {
+        if (pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) || memcmp(header.magic, MYMEMORY_FILE_MAGIC, 8) != 0 ||
+            header.version != MYMEMORY_FILE_VERSION || header.state_size != sizeof(mymemory_t) ||
+            header.file_size != (uint64_t)info.st_size || header.file_size != layout.file_size)
+        {
+            close(fd);
+            return NULL;  // Não é um pool deste formato, ou tem outro tamanho ou estratégia
+        }
+        hint = (void *)(uintptr_t)header.base;
+    }
+    else if (ftruncate(fd, (off_t)layout.file_size) != 0) // Arquivo novo: tudo zerado
+    {
+        close(fd);
+        return NULL;
+    }
+
+    char *mapping = mmap(hint, layout.file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);  // O mapeamento continua válido sem o descritor
+    if (mapping == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    mymemory_t *memory = (mymemory_t *)(mapping + MYMEMORY_FILE_STATE);
+    if (!existing)
+    {
+        memcpy(((struct mymemory_file_header *)mapping)->magic, MYMEMORY_FILE_MAGIC, 8);
+        ((struct mymemory_file_header *)mapping)->version = MYMEMORY_FILE_VERSION;
+        ((struct mymemory_file_header *)mapping)->state_size = sizeof(mymemory_t);
+        ((struct mymemory_file_header *)mapping)->file_size = layout.file_size;
+        memory->total_size = size;
+        memory->max_size = size;
+        memory->alignment = MYMEMORY_GRANULE;
+        memory->alignment_shift = (unsigned)__builtin_ctz(MYMEMORY_GRANULE);
+        memory->strategy = strategy;
+        persist_place(memory, mapping, &layout);
+        if (!persist_runtime(memory, mapping, layout.file_size))
+        {
+            munmap(mapping, layout.file_size);
+            return NULL;
+        }
+        if (!pool_setup(memory))  // Tabelas já dentro do arquivo; só as que ficam fora dele podem faltar
+        {
+            mymemory_cleanup(memory);
+            return NULL;
+        }
+        return memory;
+    }
+
+    if (memory->strategy != strategy || memory->total_size != size)
+    {
+        munmap(mapping, layout.file_size);
+        return NULL;
+    }
+    persist_place(memory, mapping, &layout);
+    size_t capacity = memory->descriptors ? size / MYMEMORY_GRANULE + 1 : 0;  // Tamanho das tabelas reservadas no arquivo
+    if (memory->descriptor_capacity != capacity || memory->index_capacity != capacity || memory->descriptors_used > capacity)
+    {
+        munmap(mapping, layout.file_size);
+        return NULL;  // Tamanhos das tabelas corrompidos: nem os ponteiros podem ser corrigidos
+    }
+    if (mapping != (char *)hint) // Mapeado em outro endereço: os ponteiros guardados precisam ser deslocados
+    {
+        persist_relocate(memory, (intptr_t)(mapping - (char *)hint));
+    }
+    if (!persist_runtime(memory, mapping, layout.file_size))
+    {
+        munmap(mapping, layout.file_size);
+        return NULL;
+    }
+    if (!persist_check(memory))
+    {
+        free(memory->instrument);
+        munmap(mapping, layout.file_size);
+        return NULL;
+    }
+    if (memory->strategy == SLAB && !slab_runs_init(memory)) // Refaz a árvore de sequências livres a partir do mapa de páginas
+    {
+        free(memory->instrument);
+        munmap(mapping, layout.file_size);
+        return NULL;
+    }
+    if (memory->strategy == BEST_FIT || memory->strategy == WORST_FIT) // Refaz a árvore por tamanho a partir da lista de livres
+    {
+        if (!size_tree_init(memory))
+        {
+            mymemory_cleanup(memory);
+            return NULL;
+        }
+        for (allocation_t *block = memory->free_blocks; block; block = block->next)
+        {
+            size_tree_insert(memory, block);
+        }
+    }
+    memory->largest_free_dirty = 1;  // Recalculado na próxima consulta
+    return memory;
+}
+
+// Grava no arquivo todo o estado de um pool persistente; retorna 0 em caso de sucesso
+int mymemory_sync(mymemory_t *memory)
+{
+    if (!memory->mapping)
+    {
+        return -1;  // Pool em memória comum
+    }
+    pool_lock(memory);
+    int result = msync(memory->mapping, memory->mapping_size, MS_SYNC);
+    pool_unlock(memory);
+    return result;
+}
+
+// Limpa memória e libera recursos
+void mymemory_cleanup(mymemory_t *memory) 
+{
+    if (memory->mapping) // Pool persistente: estrutura, tabelas e pool estão no arquivo mapeado
+    {
+        free(memory->instrument);
+        free(memory->size_nodes);
+        free(memory->slab_runs);
+        munmap(memory->mapping, memory->mapping_size);
+        return;
+    }
+    if (memory->defer_queues) // Para a thread de manutenção; liberações ainda na fila somem com o pool
+    {
+        pthread_mutex_lock(&memory->defer_lock);
+        memory->defer_stop = 1;
+        pthread_cond_signal(&memory->defer_wake);
+        pthread_mutex_unlock(&memory->defer_lock);
+        pthread_join(memory->defer_thread, NULL);
+        pthread_mutex_destroy(&memory->defer_lock);
+        pthread_cond_destroy(&memory->defer_wake);
+        free(memory->defer_queues);
+    }
+    if (memory->concurrent)
+    {
+        pthread_mutex_destroy(&memory->lock);
+        free(memory->thread_caches); // Os blocos em cache estão no pool e somem com ele
+    }
+    free(memory->slab_pages); // Tabela de páginas (Slab)
+    free(memory->slab_free_map);
+    free(memory->slab_runs);
+    free(memory->buddy_map); // Bitmaps e ordens (Buddy)
+    free(memory->buddy_order);
+    free(memory->arena_starts); // Inícios dos objetos (Arena)
+    free(memory->instrument); // Contadores de instrumentação (NULL se desativada)
+    free(memory->handles); // Tabela de handles
+    free(memory->quarantine); // Fila da quarentena (modo de depuração)
+    if (memory->region_size) // Pool crescente: as tabelas são reservas de endereços
+    {
+        if (memory->descriptors)
+        {
+            munmap(memory->descriptors, memory->descriptor_capacity * sizeof(allocation_t));
+        }
+        if (memory->index_slots)
+        {
+            munmap(memory->index_slots, memory->index_capacity * sizeof(allocation_t *));
+        }
+        if (memory->size_nodes)
+        {
+            munmap(memory->size_nodes, memory->size_node_capacity * sizeof(struct mymemory_size_node));
+        }
+    }
+    else
+    {
+        free(memory->descriptors); // Libera de uma vez todos os descritores (blocos livres e alocados)
+        free(memory->index_slots); // Libera o índice de blocos alocados
+        free(memory->size_nodes); // Nós da árvore por tamanho (Best e Worst Fit)
+    }
+    if (memory->region_size)
+    {
+        munmap(memory->pool, memory->max_size); // Pool crescente: toda a faixa reservada
+        free(memory->region_resident);
+    }
+    else
+    {
+        free(memory->pool); // Libera o pool de memória
+    }
+    free(memory); // Libera a estrutura de controle principal
+}
+
+#ifndef MYMEMORY_NO_MAIN  // Benchmarks e programa interativo; os testes (tests/) compilam só a biblioteca
+
+// Estado de uma thread do benchmark de escalabilidade
+typedef struct {
+    mymemory_t *memory;  // Pool compartilhado
+    pthread_mutex_t *global_lock;  // Lock externo em volta de cada chamada (comparação); NULL no modo concorrente
+    _Atomic(void *) *exchange;  // Blocos trocados entre threads, que geram liberações remotas
+    unsigned seed;  // Semente própria da thread
+    long operations;  // Quantidade de alocações + liberações
+} bench_thread_t;
+
+#define BENCH_SLOTS 256  // Blocos vivos por thread
+#define BENCH_EXCHANGE 1024  // Posições da área de troca entre threads
+
+// Corpo de uma thread do benchmark: alocações e liberações aleatórias, 1/16 das liberações feitas por outra thread
+static void *bench_worker(void *arg)
+{
+    bench_thread_t *bench = (bench_thread_t *)arg;
+    void *slots[BENCH_SLOTS] = { NULL };
+
+    for (long i = 0; i < bench->operations; i++)
+    {
+        int k = rand_r(&bench->seed) % BENCH_SLOTS;
+        if (slots[k]) // Libera o bloco (ou o troca com outra thread)
+        {
+            void *ptr = slots[k];
+            if (rand_r(&bench->seed) % 16 == 0)
+            {
+                ptr = atomic_exchange(&bench->exchange[rand_r(&bench->seed) % BENCH_EXCHANGE], ptr);  // Libera o bloco deixado ali, possivelmente por outra thread
+            }
+            if (ptr)
+            {
+                if (bench->global_lock) pthread_mutex_lock(bench->global_lock);
+                mymemory_free(bench->memory, ptr);
+                if (bench->global_lock) pthread_mutex_unlock(bench->global_lock);
+            }
+            slots[k] = NULL;
+        }
+        else // Aloca: na maioria blocos pequenos, às vezes até 4 KiB
+        {
+            size_t size = (rand_r(&bench->seed) % 10) ? 16 + rand_r(&bench->seed) % 240 : 256 + rand_r(&bench->seed) % 3840;
+            if (bench->global_lock) pthread_mutex_lock(bench->global_lock);
+            slots[k] = mymemory_alloc(bench->memory, size);
+            if (bench->global_lock) pthread_mutex_unlock(bench->global_lock);
+        }
+    }
+
+    for (int k = 0; k < BENCH_SLOTS; k++) // Devolve o que sobrou
+    {
+        if (slots[k])
+        {
+            if (bench->global_lock) pthread_mutex_lock(bench->global_lock);
+            mymemory_free(bench->memory, slots[k]);
+            if (bench->global_lock) pthread_mutex_unlock(bench->global_lock);
+        }
+    }
+    return NULL;
+}
+
+// Executa o benchmark com "threads" threads e retorna milhões de operações por segundo
+static double bench_run(int threads, int concurrent)
+{
+    mymemory_config_t config = { 0 };
+    config.concurrent = concurrent;
+    mymemory_t *memory = mymemory_init_config((size_t)256 << 20, SEGREGATED_FIT, &config);
+    pthread_mutex_t global_lock = PTHREAD_MUTEX_INITIALIZER;
+    _Atomic(void *) *exchange = (_Atomic(void *) *)calloc(BENCH_EXCHANGE, sizeof(*exchange));
+    pthread_t *ids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    bench_thread_t *benches = (bench_thread_t *)malloc(threads * sizeof(bench_thread_t));
+    long operations = 1000000;  // Operações por thread
+    struct timespec t0, t1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int t = 0; t < threads; t++)
+    {
+        benches[t].memory = memory;
+        benches[t].global_lock = concurrent ? NULL : &global_lock;
+        benches[t].exchange = exchange;
+        benches[t].seed = 1234u + (unsigned)t;
+        benches[t].operations = operations;
+        pthread_create(&ids[t], NULL, bench_worker, &benches[t]);
+    }
+    for (int t = 0; t < threads; t++)
+    {
+        pthread_join(ids[t], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    for (int i = 0; i < BENCH_EXCHANGE; i++) // Blocos que ficaram na área de troca
+    {
+        if (exchange[i])
+        {
+            mymemory_free(memory, exchange[i]);
+        }
+    }
+    double seconds = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+    mymemory_cleanup(memory);
+    free(exchange);
+    free(ids);
+    free(benches);
+    return (double)operations * threads / seconds / 1e6;
+}
+
+// Benchmark de escalabilidade: de 1 a "max_threads" threads, lock global externo contra o modo concorrente
+static int run_thread_benchmark(int max_threads)
+{
+    printf("Threads | Lock global (Mops/s) | Concorrente (Mops/s)\n");
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        double locked = bench_run(threads, 0);
+        double concurrent = bench_run(threads, 1);
+        printf("%7d | %20.2f | %20.2f\n", threads, locked, concurrent);
+    }
+    return 0;
+}
+
+// Evento de um trace de alocações
+typedef struct {
+    char kind;  // 'a' (alocação), 'f' (liberação), 'r' (realocação) ou 'x' (reset)
+    size_t id;  // Bloco do evento (na alocação, o bloco criado)
+    size_t new_id;  // Realocação: identificador do bloco depois de mudar de tamanho
+    size_t size;  // Tamanho pedido (alocação e realocação)
+    size_t alignment;  // Alocação: alinhamento pedido (0 = alinhamento do pool)
+} trace_event_t;
+
+// Trace carregado na memória (fora do pool) para ser repetido em cada estratégia
+typedef struct {
+    trace_event_t *events;
+    size_t count;  // Eventos no trace
+    size_t capacity;  // Eventos que cabem no vetor
+    size_t pool_size;  // Tamanho do pool na gravação (0 = desconhecido)
+    size_t max_id;  // Maior identificador usado: dimensiona a tabela de blocos da repetição
+} trace_t;
+
+// Resultado da repetição de um trace em uma estratégia
+typedef struct {
+    double mops;  // Milhões de operações por segundo (passada sem medição de latência)
+    unsigned long p50, p99, p999, max;  // Latência por operação em nanossegundos
+    size_t peak;  // Pico de bytes em uso
+    double fragmentation;  // Maior fragmentação externa observada: 1 - maior trecho livre / bytes livres
+    size_t failed;  // Alocações que falharam
+} replay_result_t;
+
+#define WORKLOAD_SLOTS 4096  // Blocos vivos no workload uniforme
+#define WORKLOAD_LIVE 8192  // Blocos vivos no workload power-law e limite da fila do produtor/consumidor
+
+// Acrescenta um evento ao trace
+static void trace_push(trace_t *trace, char kind, size_t id, size_t new_id, size_t size, size_t alignment)
+{
+    if (trace->count == trace->capacity)
+    {
+        trace->capacity = trace->capacity ? 2 * trace->capacity : 4096;
+        trace->events = (trace_event_t *)realloc(trace->events, trace->capacity * sizeof(trace_event_t));
+    }
+    trace_event_t *event = &trace->events[trace->count++];
+    event->kind = kind;
+    event->id = id;
+    event->new_id = new_id;
+    event->size = size;
+    event->alignment = alignment;
+    if (id > trace->max_id)
+    {
+        trace->max_id = id;
+    }
+    if (new_id > trace->max_id)
+    {
+        trace->max_id = new_id;
+    }
+}
+
+// Lê um trace gravado por mymemory_trace; retorna -1 se o arquivo não puder ser aberto
+static int trace_load(const char *path, trace_t *trace)
+{
+    FILE *in = fopen(path, "r");
+    char line[256];
+
+    if (!in)
+    {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), in))
+    {
+        unsigned long id = 0, new_id = 0, size = 0, alignment = 0;
+        switch (line[0])
+        {
+            case '#': // Comentário; o cabeçalho traz o tamanho do pool
+                if (sscanf(line, "# mymemory-trace 1 %lu", &size) == 1)
+                {
+                    trace->pool_size = size;
+                }
+                break;
+
+            case 'a':
+                if (sscanf(line, "a %lu %lu %lu", &id, &size, &alignment) >= 2)
+                {
+                    trace_push(trace, 'a', id, 0, size, alignment);
+                }
+                break;
+
+            case 'f':
+                if (sscanf(line, "f %lu", &id) == 1)
+                {
+                    trace_push(trace, 'f', id, 0, 0, 0);
+                }
+                break;
+
+            case 'r':
+                if (sscanf(line, "r %lu %lu %lu", &id, &new_id, &size) == 3)
+                {
+                    trace_push(trace, 'r', id, new_id, size, 0);
+                }
+                break;
+
+            case 'x':
+                trace_push(trace, 'x', 0, 0, 0, 0);
+                break;
+        }
+    }
+    fclose(in);
+    return 0;
+}
+
+// Gerador pseudoaleatório dos workloads sintéticos (xorshift64): a mesma semente gera o mesmo trace
+static uint64_t workload_random(uint64_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// Workload uniforme: tamanhos uniformes entre 16 e 4096 bytes, alocações e liberações em posições aleatórias
+static void workload_uniform(trace_t *trace, size_t operations, uint64_t seed)
+{
+    size_t slots[WORKLOAD_SLOTS] = { 0 };  // Identificador + 1 do bloco em cada posição (0 = vazia)
+    size_t next_id = 0;
+
+    while (trace->count < operations)
+    {
+        size_t k = workload_random(&seed) % WORKLOAD_SLOTS;
+        if (!slots[k])
+        {
+            slots[k] = ++next_id;
+            trace_push(trace, 'a', slots[k] - 1, 0, 16 + workload_random(&seed) % 4081, 0);
+        }
+        else if (workload_random(&seed) % 8 == 0) // Às vezes muda de tamanho em vez de liberar
+        {
+            trace_push(trace, 'r', slots[k] - 1, slots[k] - 1, 16 + workload_random(&seed) % 4081, 0);
+        }
+        else
+        {
+            trace_push(trace, 'f', slots[k] - 1, 0, 0, 0);
+            slots[k] = 0;
+        }
+    }
+    for (size_t k = 0; k < WORKLOAD_SLOTS; k++) // Libera o que sobrou
+    {
+        if (slots[k])
+        {
+            trace_push(trace, 'f', slots[k] - 1, 0, 0, 0);
+        }
+    }
+}
+
+// Workload power-law: a maioria dos blocos é pequena e morre cedo, poucos são grandes ou vivem muito
+static void workload_powerlaw(trace_t *trace, size_t operations, uint64_t seed)
+{
+    size_t *live = (size_t *)malloc(WORKLOAD_LIVE * sizeof(size_t));  // Blocos vivos, do mais antigo ao mais novo
+    size_t count = 0, next_id = 0;
+
+    while (trace->count < operations)
+    {
+        uint64_t r = workload_random(&seed);
+        if (count < WORKLOAD_LIVE && (count == 0 || r % 2)) // Aloca: a classe de tamanho tem distribuição geométrica
+        {
+            int order = __builtin_ctzll(workload_random(&seed) | (1ULL << 14));  // 16 << order bytes com probabilidade 2^-(order + 1)
+            size_t base = (size_t)MYMEMORY_GRANULE << order;
+            live[count++] = next_id;
+            trace_push(trace, 'a', next_id++, 0, base + workload_random(&seed) % base, 0);
+        }
+        else // Libera: a idade também tem distribuição geométrica, então os mais novos morrem primeiro
+        {
+            size_t age = (size_t)__builtin_ctzll(workload_random(&seed) | (1ULL << 40));
+            size_t k = age < count ? count - 1 - age : 0;
+            trace_push(trace, 'f', live[k], 0, 0, 0);
+            live[k] = live[--count];
+        }
+    }
+    while (count) // Libera o que sobrou
+    {
+        trace_push(trace, 'f', live[--count], 0, 0, 0);
+    }
+    free(live);
+}
+
+// Workload produtor/consumidor: rajadas de mensagens alocadas e liberadas em ordem de chegada (fila)
+static void workload_prodcons(trace_t *trace, size_t operations, uint64_t seed)
+{
+    static const size_t sizes[] = { 32, 64, 128, 256, 512, 1024, 4096 };  // Tamanhos de mensagem
+    size_t *queue = (size_t *)malloc(WORKLOAD_LIVE * sizeof(size_t));  // Fila circular de mensagens
+    size_t head = 0, count = 0, next_id = 0;
+
+    while (trace->count < operations)
+    {
+        size_t burst = 1 + workload_random(&seed) % 64;
+        int produce = count < WORKLOAD_LIVE / 2 || (count < WORKLOAD_LIVE - 64 && workload_random(&seed) % 2);
+        for (size_t i = 0; i < burst; i++)
+        {
+            if (produce)
+            {
+                queue[(head + count++) % WORKLOAD_LIVE] = next_id;
+                trace_push(trace, 'a', next_id++, 0, sizes[workload_random(&seed) % 7], 0);
+            }
+            else if (count)
+            {
+                trace_push(trace, 'f', queue[head], 0, 0, 0);
+                head = (head + 1) % WORKLOAD_LIVE;
+                count--;
+            }
+        }
+    }
+    while (count) // Consome o que sobrou
+    {
+        trace_push(trace, 'f', queue[head], 0, 0, 0);
+        head = (head + 1) % WORKLOAD_LIVE;
+        count--;
+    }
+    free(queue);
+}
+
+// Gera um workload sintético pelo nome; retorna -1 se o nome for desconhecido
+static int workload_generate(const char *name, trace_t *trace, size_t operations)
+{
+    if (strcmp(name, "uniform") == 0)
+    {
+        workload_uniform(trace, operations, 42);
+    }
+    else if (strcmp(name, "powerlaw") == 0)
+    {
+        workload_powerlaw(trace, operations, 42);
+    }
+    else if (strcmp(name, "prodcons") == 0)
+    {
+        workload_prodcons(trace, operations, 42);
+    }
+    else
+    {
+        return -1;
+    }
+    return 0;
+}
+
+// Executa um evento do trace; "slots" liga os identificadores do trace aos blocos deste pool
+static void replay_event(mymemory_t *memory, void **slots, size_t slot_count, const trace_event_t *event)
+{
+    switch (event->kind)
+    {
+        case 'a':
+            slots[event->id] = event->alignment ? mymemory_alloc_aligned(memory, event->size, event->alignment) : mymemory_alloc(memory, event->size);
+            break;
+
+        case 'f':
+            if (slots[event->id]) // Blocos cuja alocação falhou nesta estratégia não existem
+            {
+                mymemory_free(memory, slots[event->id]);
+                slots[event->id] = NULL;
+            }
+            break;
+
+        case 'r':
+        {
+            void *moved = mymemory_realloc(memory, slots[event->id], event->size);
+            if (moved)
+            {
+                slots[event->id] = NULL;
+                slots[event->new_id] = moved;
+            }
+            break;
+        }
+
+        case 'x':
+            mymemory_reset(memory);
+            memset(slots, 0, slot_count * sizeof(void *));
+            break;
+    }
+}
+
+// Compara latências (para qsort)
+static int compare_latencies(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Nanossegundos entre dois instantes
+static uint64_t elapsed_ns(const struct timespec *t0, const struct timespec *t1)
+{
+    return (uint64_t)(t1->tv_sec - t0->tv_sec) * 1000000000ULL + (uint64_t)t1->tv_nsec - (uint64_t)t0->tv_nsec;
+}
+
+// Repete o trace em uma estratégia: uma passada só para a vazão e outra medindo cada operação
+// "harden" liga o modo de depuração (só vale nas estratégias com descritores)
+static int replay_run(const trace_t *trace, AllocationStrategy strategy, int harden, replay_result_t *result)
+{
+    mymemory_config_t config = { 0 };
+    config.harden = harden;  // Modo de depuração, para medir o seu custo
+    size_t slot_count = trace->max_id + 1;
+    void **slots = (void **)calloc(slot_count, sizeof(void *));
+    uint32_t *latencies = (uint32_t *)malloc((trace->count ? trace->count : 1) * sizeof(uint32_t));
+    struct timespec t0, t1;
+
+    mymemory_t *memory = mymemory_init_config(trace->pool_size, strategy, &config);
+    if (!memory || !slots || !latencies)
+    {
+        free(slots);
+        free(latencies);
+        return -1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (size_t i = 0; i < trace->count; i++)
+    {
+        replay_event(memory, slots, slot_count, &trace->events[i]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    result->mops = (double)trace->count / ((double)elapsed_ns(&t0, &t1) / 1e9) / 1e6;
+    mymemory_cleanup(memory);
+
+    memset(slots, 0, slot_count * sizeof(void *));
+    memory = mymemory_init_config(trace->pool_size, strategy, &config);
+    if (!memory)
+    {
+        free(slots);
+        free(latencies);
+        return -1;
+    }
+    result->fragmentation = 0;
+    for (size_t i = 0; i < trace->count; i++)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        replay_event(memory, slots, slot_count, &trace->events[i]);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        uint64_t ns = elapsed_ns(&t0, &t1);
+        latencies[i] = ns > UINT32_MAX ? UINT32_MAX : (uint32_t)ns;
+
+        if (i % 1024 == 0) // Amostra da fragmentação externa, fora da medição
+        {
+            mymemory_stats_t stats = mymemory_get_stats(memory);
+            double fragmentation = stats.bytes_free ? 1.0 - (double)stats.largest_free_block / (double)stats.bytes_free : 0.0;
+            if (fragmentation > result->fragmentation)
+            {
+                result->fragmentation = fragmentation;
+            }
+        }
+    }
+    mymemory_stats_t stats = mymemory_get_stats(memory);
+    result->peak = stats.peak_bytes_in_use;
+    result->failed = stats.failed_allocations;
+#ifdef MYMEMORY_INSTRUMENT
+    mymemory_instrument_dump(memory, stderr); // Fora da tabela de resultados (stdout)
+#endif
+    mymemory_cleanup(memory);
+
+    qsort(latencies, trace->count, sizeof(uint32_t), compare_latencies);
+    size_t last = trace->count ? trace->count - 1 : 0;
+    result->p50 = trace->count ? latencies[last / 2] : 0;
+    result->p99 = trace->count ? latencies[last * 99 / 100] : 0;
+    result->p999 = trace->count ? latencies[last * 999 / 1000] : 0;
+    result->max = trace->count ? latencies[last] : 0;
+    free(latencies);
+    free(slots);
+    return 0;
+}
+
+// Repete o trace em todas as estratégias e imprime uma linha de resultados para cada uma
+static int run_replay_benchmark(trace_t *trace, size_t pool_size, int harden)
+{
+    if (pool_size)
+    {
+        trace->pool_size = pool_size;  // O tamanho da linha de comando tem precedência sobre o do cabeçalho
+    }
+    if (!trace->pool_size)
+    {
+        trace->pool_size = (size_t)64 << 20;
+    }
+    printf("Trace: %lu eventos, pool de %lu bytes\n", (unsigned long)trace->count, (unsigned long)trace->pool_size);
+    printf("Estrategia     |   Mops/s |  p50 ns |  p99 ns | p99.9 ns |   max ns | Pico (KiB) | Frag. ext. | Falhas\n");
+    for (int strategy = FIRST_FIT; strategy <= BUDDY; strategy++)
+    {
+        for (int hardened = 0; hardened <= (harden && strategy <= SEGREGATED_FIT); hardened++) // Com --harden, cada estratégia com descritores repete no modo de depuração
+        {
+            const char *name = hardened ? "  + depuracao" : strategy_name((AllocationStrategy)strategy);
+            replay_result_t result;
+            if (replay_run(trace, (AllocationStrategy)strategy, hardened, &result) != 0)
+            {
+                printf("%-14s | falha ao inicializar o pool\n", name);
+                continue;
+            }
+            printf("%-14s | %8.2f | %7lu | %7lu | %8lu | %8lu | %10lu | %9.1f%% | %lu\n", name, result.mops,
+                   result.p50, result.p99, result.p999, result.max, (unsigned long)(result.peak / 1024), 100.0 * result.fragmentation, (unsigned long)result.failed);
+        }
+    }
+    free(trace->events);
+    return 0;
+}
+
+// Grava em "path" o trace de uma execução instrumentada de um workload sintético (Segregated Fit)
+static int record_workload(const char *name, const char *path, size_t operations)
+{
+    trace_t trace = { 0 };
+    if (workload_generate(name, &trace, operations) != 0)
+    {
+        printf("Workload desconhecido: %s (use uniform, powerlaw ou prodcons)\n", name);
+        return 1;
+    }
+
+    mymemory_config_t config = { 0 };
+    mymemory_t *memory = mymemory_init_config((size_t)64 << 20, SEGREGATED_FIT, &config);
+    void **slots = (void **)calloc(trace.max_id + 1, sizeof(void *));
+    if (!memory || !slots)
+    {
+        printf("%-14s | falha ao inicializar o pool\n", strategy_name(SEGREGATED_FIT));
+        if (memory)
+        {
+            mymemory_cleanup(memory);
+        }
+        free(slots);
+        free(trace.events);
+        return 1;
+    }
+    FILE *out = fopen(path, "w");
+    if (!out)
+    {
+        printf("Nao foi possivel criar %s\n", path);
+        mymemory_cleanup(memory);
+        free(slots);
+        free(trace.events);
+        return 1;
+    }
+    mymemory_trace(memory, out);
+    for (size_t i = 0; i < trace.count; i++)
+    {
+        replay_event(memory, slots, trace.max_id + 1, &trace.events[i]);
+    }
+    mymemory_trace(memory, NULL);
+    fclose(out);
+    mymemory_cleanup(memory);
+    free(slots);
+    printf("%lu eventos gravados em %s\n", (unsigned long)trace.count, path);
+    free(trace.events);
+    return 0;
+}
+
+// Thread do benchmark de liberações: mesma mistura do benchmark de escalabilidade, medindo cada mymemory_free
+typedef struct {
+    mymemory_t *memory;
+    unsigned seed;  // Semente própria (rand_r)
+    long operations;  // Operações a executar
+    uint32_t *latencies;  // Latência de cada liberação medida (ns)
+    size_t count;  // Liberações medidas
+} free_bench_t;
+
+static void *free_bench_worker(void *arg)
+{
+    free_bench_t *bench = (free_bench_t *)arg;
+    void *slots[BENCH_SLOTS] = { NULL };
+    struct timespec t0, t1;
+
+    for (long i = 0; i < bench->operations; i++)
+    {
+        int k = rand_r(&bench->seed) % BENCH_SLOTS;
+        if (slots[k])
+        {
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            mymemory_free(bench->memory, slots[k]);
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+            uint64_t ns = elapsed_ns(&t0, &t1);
+            bench->latencies[bench->count++] = ns > UINT32_MAX ? UINT32_MAX : (uint32_t)ns;
+            slots[k] = NULL;
+        }
+        else // Aloca: na maioria blocos pequenos, às vezes até 4 KiB
+        {
+            size_t size = (rand_r(&bench->seed) % 10) ? 16 + rand_r(&bench->seed) % 240 : 256 + rand_r(&bench->seed) % 3840;
+            slots[k] = mymemory_alloc(bench->memory, size);
+        }
+    }
+
+    for (int k = 0; k < BENCH_SLOTS; k++) // Devolve o que sobrou, fora da medição
+    {
+        if (slots[k])
+        {
+            mymemory_free(bench->memory, slots[k]);
+        }
+    }
+    return NULL;
+}
+
+// Executa o benchmark de liberações em uma estratégia, com liberações síncronas ou adiadas, e imprime uma linha
+static void free_bench_run(AllocationStrategy strategy, int threads, int deferred)
+{
+    mymemory_config_t config = { 0 };
+    config.concurrent = 1;
+    config.deferred_free = deferred;
+    mymemory_t *memory = mymemory_init_config((size_t)256 << 20, strategy, &config);
+    pthread_t *ids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    free_bench_t *benches = (free_bench_t *)malloc(threads * sizeof(free_bench_t));
+    long operations = 1000000;  // Operações por thread
+    struct timespec t0, t1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int t = 0; t < threads; t++)
+    {
+        benches[t].memory = memory;
+        benches[t].seed = 1234u + (unsigned)t;
+        benches[t].operations = operations;
+        benches[t].latencies = (uint32_t *)malloc(operations * sizeof(uint32_t));
+        benches[t].count = 0;
+        pthread_create(&ids[t], NULL, free_bench_worker, &benches[t]);
+    }
+    for (int t = 0; t < threads; t++)
+    {
+        pthread_join(ids[t], NULL);
+    }
+    mymemory_flush(memory);  // A vazão inclui as liberações que a thread de manutenção ainda devia
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    size_t total = 0;
+    for (int t = 0; t < threads; t++)
+    {
+        total += benches[t].count;
+    }
+    uint32_t *latencies = (uint32_t *)malloc((total ? total : 1) * sizeof(uint32_t));
+    total = 0;
+    for (int t = 0; t < threads; t++)
+    {
+        memcpy(latencies + total, benches[t].latencies, benches[t].count * sizeof(uint32_t));
+        total += benches[t].count;
+        free(benches[t].latencies);
+    }
+    qsort(latencies, total, sizeof(uint32_t), compare_latencies);
+
+    printf("%-14s | %-9s | %8.2f | %7lu | %7lu | %8lu | %8lu\n", strategy_name(strategy), deferred ? "adiada" : "sincrona",
+           (double)operations * threads / ((double)elapsed_ns(&t0, &t1) / 1e9) / 1e6,
+           total ? (unsigned long)latencies[total / 2] : 0UL, total ? (unsigned long)latencies[total * 99 / 100] : 0UL,
+           total ? (unsigned long)latencies[total * 999 / 1000] : 0UL, total ? (unsigned long)latencies[total - 1] : 0UL);
+    mymemory_cleanup(memory);
+    free(latencies);
+    free(ids);
+    free(benches);
+}
+
+// Benchmark de latência da liberação: liberações síncronas contra adiadas, com "threads" threads
+static int run_free_benchmark(int threads)
+{
+    if (threads < 1 || threads >= MYMEMORY_MAX_THREADS)
+    {
+        threads = threads < 1 ? 1 : MYMEMORY_MAX_THREADS - 1;  // Um slot fica para a thread de manutenção
+    }
+    printf("Liberacoes com %d threads\n", threads);
+    printf("Estrategia     | Liberacao |   Mops/s |  p50 ns |  p99 ns | p99.9 ns |   max ns\n");
+    for (int strategy = FIRST_FIT; strategy <= SEGREGATED_FIT; strategy++)
+    {
+        free_bench_run((AllocationStrategy)strategy, threads, 0);
+        free_bench_run((AllocationStrategy)strategy, threads, 1);
+    }
+    return 0;
+}
+
+void display_menu() {
+    printf("\n--- Menu de Gerenciamento de Memoria ---\n");
+    printf("1. Inicializar memoria\n");
+    printf("2. Alocar memoria\n");
+    printf("3. Liberar memoria\n");
+    printf("4. Exibir alocacoes atuais\n");
+    printf("5. Exibir estatisticas de memoria\n");
+    printf("6. Layout da memoria\n");
+    printf("7. Limpar memoria e sair\n");
+    printf("Escolha uma opcao: ");
+}
+
+int main(int argc, char *argv[]) {
+    int harden = argc > 3 && strcmp(argv[argc - 1], "--harden") == 0; // Benchmarks: mede também o modo de depuração
+    if (harden)
+    {
+        argc--;
+    }
+    if (argc > 2 && strcmp(argv[1], "--bench-threads") == 0) // Modo sem menu: benchmark de escalabilidade
+    {
+        return run_thread_benchmark(atoi(argv[2]));
+    }
+    if (argc > 2 && strcmp(argv[1], "--bench-free") == 0) // Latência da liberação: síncrona contra adiada
+    {
+        return run_free_benchmark(atoi(argv[2]));
+    }
+    if (argc > 2 && strcmp(argv[1], "--replay") == 0) // Repete um trace gravado em todas as estratégias
+    {
+        trace_t trace = { 0 };
+        if (trace_load(argv[2], &trace) != 0)
+        {
+            printf("Nao foi possivel abrir %s\n", argv[2]);
+            return 1;
+        }
+        return run_replay_benchmark(&trace, argc > 3 ? strtoul(argv[3], NULL, 10) : 0, harden);
+    }
+    if (argc > 2 && strcmp(argv[1], "--workload") == 0) // Workload sintético em todas as estratégias
+    {
+        trace_t trace = { 0 };
+        if (workload_generate(argv[2], &trace, argc > 3 ? strtoul(argv[3], NULL, 10) : 1000000) != 0)
+        {
+            printf("Workload desconhecido: %s (use uniform, powerlaw ou prodcons)\n", argv[2]);
+            return 1;
+        }
+        return run_replay_benchmark(&trace, 0, harden);
+    }
+    if (argc > 3 && strcmp(argv[1], "--record") == 0) // Grava o trace de uma execução de um workload sintético
+    {
+        return record_workload(argv[2], argv[3], argc > 4 ? strtoul(argv[4], NULL, 10) : 1000000);
+    }
+
+    mymemory_t *memory = NULL;
+    AllocationStrategy strategy;
+    size_t pool_size, alloc_size;
+    int option;
+    void *allocated_ptr;
+
+    while (1) 
+    {
+        display_menu();
+        scanf("%d", &option);
+
+        switch (option) {
+            case 1: // Inicializar memória
+                if (memory != NULL) 
+                {
+                    printf("Memoria ja foi inicializada. Limpe antes de reinicializar.\n");
+                    break;
+                }
+                printf("Digite o tamanho do pool de memoria: ");
+                scanf("%zu", &pool_size);
+                printf("Escolha a estrategia de alocacao (0: First Fit, 1: Best Fit, 2: Worst Fit, 3: Segregated Fit, 4: Arena, 5: Slab, 6: Buddy): ");
+                int strat_option;
+                scanf("%d", &strat_option);
+
+                strategy = (strat_option >= 0 && strat_option <= BUDDY) ? (AllocationStrategy)strat_option : FIRST_FIT;
+                memory = mymemory_init(pool_size, strategy);
+                printf("Memoria inicializada com %zu bytes usando a estrategia %s.\n",
+                       pool_size, strategy_name(strategy));
+                break;
+
+            case 2: // Alocar memória
+                if (memory == NULL) 
+                {
+                    printf("Inicialize a memoria primeiro.\n");
+                    break;
+                }
+                printf("Digite o tamanho do bloco a ser alocado: ");
+                scanf("%zu", &alloc_size);
+                allocated_ptr = mymemory_alloc(memory, alloc_size);
+
+                if (allocated_ptr != NULL) 
+                {
+                    printf("Memoria alocada no endereco 0x%p.\n", allocated_ptr);
+                } 
+                else 
+                {
+                    printf("Falha ao alocar memoria. Tente um tamanho menor ou verifique o pool disponivel.\n");
+                }
+                break;
+
+            case 3: // Liberar memória
+                if (memory == NULL) 
+                {
+                    printf("Inicialize a memoria primeiro.\n");
+                    break;
+                }
+                printf("Digite o endereco (em hexadecimal sem o '0x') do bloco a ser liberado: ");
+                scanf("%p", &allocated_ptr);
+                mymemory_free(memory, allocated_ptr);
+                // printf("Memoria no endereco 0x%p liberada.\n", allocated_ptr);
+                break;
+
+            case 4: // Exibir alocações atuais
+                if (memory == NULL) 
+                {
+                    printf("Inicialize a memoria primeiro.\n");
+                    break;
+                }
+                mymemory_display(memory);
+                break;
+
+            case 5: // Exibir estatísticas de memória
+                if (memory == NULL) 
+                {
+                    printf("Inicialize a memoria primeiro.\n");
+                    break;
+                }
+                mymemory_stats(memory);
+                break;
+
+            case 6: // Exibir layout da memória
+                if (memory == NULL) 
+                {
+                    printf("Inicialize a memoria primeiro.\n");
+                    break;
+                }
+                print_memory_layout(memory);  // Chamada para exibir o layout da memória
+                break;
+
+            case 7: // Limpar memória e sair
+                if (memory != NULL) 
+                {
+                    mymemory_cleanup(memory);
+                    printf("Memoria limpa e todos os recursos liberados.\n");
+                }
+                printf("Encerrando programa.\n");
+                return 0;
+
+            default:
+                printf("Opcao invalida. Tente novamente.\n");
+                break;
+        }
+    }
+    return 0;
+}
+
+#endif  // MYMEMORY_NO_MAIN
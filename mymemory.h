@@ -2,33 +2,213 @@
 #define MYMEMORY_H
 
 #include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#define MYMEMORY_GRANULE 16  // Alinhamento mínimo: todo bloco começa em e tem tamanho múltiplo de um valor >= a este
+#define MYMEMORY_CACHE_LINE 64  // Alinhamento de linha de cache, para uso em mymemory_config_t
+#define MYMEMORY_MAX_THREADS 64  // Threads com cache próprio ao mesmo tempo (modo concorrente)
+#define MYMEMORY_CACHE_MAX_SIZE 256  // Maior tamanho servido pelos caches de thread
+#define MYMEMORY_CACHE_CLASSES (MYMEMORY_CACHE_MAX_SIZE / MYMEMORY_GRANULE)  // Classes de tamanho de cada cache
+#define MYMEMORY_CACHE_BATCH 32  // Blocos trazidos do (ou devolvidos ao) pool compartilhado de uma vez
+#define MYMEMORY_SLAB_PAGE 4096  // Tamanho das páginas da estratégia Slab
+#define MYMEMORY_SLAB_CLASSES 6  // Classes de objetos do Slab: 16, 32, 64, 128, 256 e 512 bytes
+#define MYMEMORY_SLAB_MAX_SIZE (MYMEMORY_GRANULE << (MYMEMORY_SLAB_CLASSES - 1))  // Maior objeto guardado em página de classe
+#define MYMEMORY_BUDDY_ORDERS 48  // Ordens do Buddy: blocos de MYMEMORY_GRANULE << ordem bytes
+#define MYMEMORY_SL_LOG2 4  // Log2 da quantidade de subclasses por classe de tamanho (Segregated Fit)
+#define MYMEMORY_SL_COUNT (1 << MYMEMORY_SL_LOG2)  // Subclasses (segundo nível) por classe
+#define MYMEMORY_FL_COUNT (64 - MYMEMORY_SL_LOG2 + 1)  // Classes de primeiro nível (uma por potência de 2)
+#define MYMEMORY_REGION_SIZE (2 * 1024 * 1024)  // Tamanho padrão das regiões de um pool crescente (uma página grande)
+#define MYMEMORY_INSTRUMENT_CLASSES 24  // Instrumentação: classes de tamanho (até 16, 32, 64, ... bytes; a última inclui as maiores)
+#define MYMEMORY_INSTRUMENT_BUCKETS 32  // Instrumentação: faixas logarítmicas de latência (ns) e de comprimento de busca
+#define MYMEMORY_GUARD_SIZE 16  // Modo de depuração: bytes mínimos de guarda depois de cada bloco (inclui o tamanho pedido, guardado no fim)
+#define MYMEMORY_QUARANTINE 256  // Modo de depuração: blocos liberados que esperam na quarentena antes de voltar ao pool
+#define MYMEMORY_POISON_SIZE 64  // Modo de depuração: bytes envenenados no início de cada bloco liberado (0 = o bloco inteiro)
+#define MYMEMORY_DEFER_QUEUE 1024  // Liberações adiadas: posições da fila de cada slot de thread (cheia = liberação síncrona)
+#define MYMEMORY_DEFER_INTERVAL_US 1000  // Liberações adiadas: a thread de manutenção drena as filas pelo menos a cada intervalo
+#define MYMEMORY_SIZE_FANOUT 16  // Chaves por nó da árvore de blocos livres por tamanho (Best Fit e Worst Fit)
 
 typedef enum {
     FIRST_FIT,
     BEST_FIT,
-    WORST_FIT
+    WORST_FIT,
+    SEGREGATED_FIT,  // Listas segregadas por classe de tamanho com bitmaps de dois níveis (TLSF)
+    ARENA,  // Incremento de ponteiro; tudo é liberado de uma vez por mymemory_reset ou mymemory_rollback
+    SLAB,  // Páginas por classe de tamanho com bitmap de posições; objetos grandes em páginas inteiras
+    BUDDY  // Blocos de potência de 2 divididos e juntados aos pares; pior caso O(log n)
 } AllocationStrategy;
 
 typedef struct allocation {
     void *start;
     size_t size;
     struct allocation *next;
+    struct allocation *prev;  // Anterior na lista em que o bloco está (remoção em O(1))
+    struct allocation *phys_prev;  // Bloco imediatamente anterior no pool (livre ou alocado)
+    struct allocation *phys_next;  // Bloco imediatamente posterior no pool (livre ou alocado)
+    int is_free;  // 1 se o bloco está livre, 0 se está alocado
+    int owner;  // Slot + 1 da thread cujo cache guarda o bloco (0 = nenhum)
+    uint32_t handle;  // Handle que referencia o bloco (0 = bloco comum, que nunca muda de lugar)
+    uint16_t quarantined;  // Modo de depuração: 1 se o bloco já foi liberado e espera na quarentena
+    uint16_t cached;  // Modo concorrente: 1 se o bloco está livre em um cache de thread (pilha local ou remota)
 } allocation_t;
 
+typedef uint64_t mymemory_handle_t;  // Referência a um bloco que a compactação pode mudar de lugar (0 = inválido): entrada da tabela nos 32 bits de baixo, geração nos de cima
+
+typedef struct {
+    size_t alignment;  // Alinhamento mínimo de todo bloco (potência de 2; 0 usa MYMEMORY_GRANULE)
+    int concurrent;  // 1 para permitir uso simultâneo por várias threads (lock + caches por thread)
+    int verbose;  // 1 para imprimir mensagens nas liberações (programa interativo)
+    size_t max_size;  // Maior que o tamanho inicial: o pool cresce sob demanda em regiões mapeadas com mmap (não vale para Slab e Buddy)
+    size_t region_size;  // Tamanho das regiões do pool crescente (0 usa MYMEMORY_REGION_SIZE)
+    int huge_pages;  // 1 para pedir páginas grandes ao pool crescente (MAP_HUGETLB, ou MADV_HUGEPAGE se não houver)
+    int deferred_free;  // 1 para liberações adiadas: mymemory_free só enfileira e uma thread de manutenção as faz em lotes (liga o modo concorrente; não vale para a Arena)
+    int harden;  // 1 para o modo de depuração: zonas de guarda, envenenamento, quarentena e detecção de liberação dupla (não vale para Arena, Slab e Buddy)
+} mymemory_config_t;
+
+struct mymemory_thread_cache;
+struct mymemory_slab_page;
+struct mymemory_slab_run;
+struct mymemory_instrument;
+struct mymemory_handle;
+struct mymemory_size_node;
+struct mymemory_defer_queue;
+
+typedef struct {
+    size_t top;  // Topo da arena no momento da marca
+    size_t last;  // Último objeto alocado no momento da marca
+    size_t count;  // Objetos alocados no momento da marca
+} mymemory_marker_t;
+
+typedef struct {
+    size_t total_size;  // Tamanho do pool
+    size_t bytes_in_use;  // Bytes em blocos alocados (inclui os guardados nos caches de thread)
+    size_t peak_bytes_in_use;  // Maior valor de bytes_in_use desde o mymemory_init
+    size_t bytes_free;  // Bytes fora de blocos alocados
+    size_t allocated_blocks;  // Blocos alocados
+    size_t free_blocks;  // Trechos livres (blocos livres; no Slab, sequências de páginas livres)
+    size_t largest_free_block;  // Maior trecho livre: o maior pedido que ainda pode ser atendido sem alinhamento extra
+                                // Refeito só quando uma alocação pode tê-lo diminuído: O(log n) no Best/Worst Fit, O(1) no Slab, Buddy e Arena;
+                                // O(n) no First Fit (percorre a lista de livres) e no Segregated Fit (percorre a lista da maior subclasse)
+    size_t failed_allocations;  // Alocações que retornaram NULL por falta de espaço
+    size_t internal_fragmentation;  // Buddy: bytes dos blocos alocados além do que foi pedido
+    size_t resident_size;  // Bytes das regiões que podem ter páginas residentes (pool crescente; nos demais, o pool todo)
+    size_t pending_frees;  // Liberações adiadas que ainda esperam nas filas
+    size_t guard_errors;  // Modo de depuração: zonas de guarda sobrescritas, blocos alterados depois de liberados e liberações inválidas
+} mymemory_stats_t;
+
+typedef struct {
+    void *start;  // Primeiro byte do trecho
+    size_t size;  // Bytes do trecho
+    int is_free;  // 1 se o trecho está livre, 0 se está alocado
+} mymemory_extent_t;
+
+// Chamado para cada trecho do pool em ordem de endereços; retornar algo diferente de 0 interrompe o percurso
+typedef int (*mymemory_extent_cb)(const mymemory_extent_t *extent, void *context);
+
+typedef enum {
+    MYMEMORY_SNAPSHOT_JSON,  // {"strategy":...,"total_size":...,"extents":[{"offset":...,"size":...,"free":...},...]}
+    MYMEMORY_SNAPSHOT_CSV,  // Cabeçalho "offset,size,free" e uma linha por trecho
+    MYMEMORY_SNAPSHOT_BINARY  // Cabeçalho de 24 bytes e registros de 16 bytes, na ordem de bytes da máquina
+} mymemory_snapshot_format_t;
+
 typedef struct {
     void *pool;
-    size_t total_size;
+    size_t total_size;  // Tamanho atual do pool (cresce até max_size no pool crescente)
+    size_t max_size;  // Maior tamanho que o pool pode ter (igual a total_size se ele não cresce)
+    size_t region_size;  // Pool crescente: tamanho de cada região (0 = pool fixo, sem regiões)
+    uint64_t *region_resident;  // Pool crescente: bit ligado para cada região que pode ter páginas residentes
+    int region_hugetlb;  // Pool crescente: mapeado com MAP_HUGETLB
     allocation_t *free_blocks;
     allocation_t *allocated_blocks;
-    allocation_t *head;
+    allocation_t *head;  // Primeiro bloco do pool em ordem de endereços (encadeamento físico)
+    allocation_t **index_slots;  // Índice dos blocos alocados (um slot por unidade de alocação do pool)
+    size_t index_capacity;  // Quantidade de posições do índice
+    size_t index_count;  // Quantidade de blocos registrados no índice
+    allocation_t *descriptors;  // Slab com todos os descritores de bloco, reservado no mymemory_init
+    size_t descriptor_capacity;  // Quantidade de entradas do slab
+    size_t descriptors_used;  // Entradas do slab já tocadas pelo menos uma vez
+    allocation_t *free_descriptors;  // Entradas devolvidas, prontas para reuso
     AllocationStrategy strategy;
+    size_t alignment;  // Alinhamento mínimo efetivo: unidade de alocação do pool
+    unsigned alignment_shift;  // log2(alignment), usado para indexar os blocos
+    int verbose;  // Imprime mensagens nas liberações
+    int concurrent;  // Modo concorrente: operações no pool compartilhado protegidas por "lock"
+    pthread_mutex_t lock;  // Protege listas, índice e slab de descritores no modo concorrente
+    struct mymemory_thread_cache *thread_caches;  // Um cache de blocos pequenos por slot de thread
+    size_t arena_top;  // Arena: deslocamento do primeiro byte livre
+    size_t arena_last;  // Arena: deslocamento do último objeto alocado (SIZE_MAX se desconhecido)
+    size_t arena_count;  // Arena: objetos alocados desde o último reset
+    uint64_t *arena_starts;  // Arena: bit ligado para cada unidade de alocação em que começa um objeto (só valem os abaixo do topo)
+    size_t arena_dirty;  // Arena: maior topo desde a criação; entre o topo e ele podem sobrar marcas antigas
+    struct mymemory_slab_page *slab_pages;  // Slab: um registro por página do pool
+    size_t slab_page_count;  // Slab: páginas inteiras no pool
+    uint64_t *slab_free_map;  // Slab: bit ligado para cada página livre
+    struct mymemory_slab_run *slab_runs;  // Slab: árvore de segmentos sobre o mapa de páginas (maior sequência livre em O(1))
+    size_t slab_run_leaves;  // Slab: folhas da árvore de segmentos (potência de 2 >= páginas)
+    int32_t slab_partial[MYMEMORY_SLAB_CLASSES];  // Slab: primeira página com posição livre de cada classe (-1 = nenhuma)
+    uint64_t *buddy_map;  // Buddy: um bitmap por ordem, bit ligado para cada bloco livre daquela ordem
+    size_t buddy_map_offset[MYMEMORY_BUDDY_ORDERS];  // Buddy: primeira palavra do bitmap de cada ordem
+    size_t buddy_free[MYMEMORY_BUDDY_ORDERS];  // Buddy: deslocamento do primeiro bloco livre de cada ordem (SIZE_MAX = nenhum)
+    uint64_t buddy_nonempty;  // Buddy: bit ligado para cada ordem com bloco livre
+    uint8_t *buddy_order;  // Buddy: ordem do bloco alocado que começa em cada grânulo
+    size_t buddy_requested;  // Buddy: bytes pedidos pelos blocos alocados (a diferença é a fragmentação interna)
+    mymemory_stats_t counters;  // Estatísticas mantidas a cada operação (maior trecho livre só vale se não estiver "sujo")
+    int largest_free_dirty;  // 1 se o maior trecho livre pode ter diminuído e precisa ser recalculado
+    struct mymemory_handle *handles;  // Tabela de handles (a entrada 0 não é usada)
+    uint32_t handle_capacity;  // Entradas da tabela de handles
+    uint32_t handle_free;  // Primeira entrada livre da tabela (0 = nenhuma)
+    int harden;  // Modo de depuração ligado
+    struct mymemory_defer_queue *defer_queues;  // Liberações adiadas: uma fila por slot de thread (NULL = liberações síncronas)
+    pthread_mutex_t defer_lock;  // Serializa quem drena as filas (thread de manutenção e mymemory_flush)
+    pthread_cond_t defer_wake;  // Acorda a thread de manutenção antes do fim do intervalo
+    pthread_t defer_thread;  // Thread de manutenção
+    int defer_stop;  // 1 quando mymemory_cleanup pede o fim da thread de manutenção
+    allocation_t **quarantine;  // Modo de depuração: fila circular dos blocos liberados mais recentes
+    size_t quarantine_head;  // Posição do bloco mais antigo da fila
+    size_t quarantine_count;  // Blocos na fila
+    size_t compact_cursor;  // Deslocamento do último bloco alocado visitado pela compactação (SIZE_MAX = recomeçar do início)
+    struct mymemory_size_node *size_nodes;  // Best e Worst Fit: nós da árvore de livres por (tamanho, endereço), reservados no mymemory_init
+    size_t size_node_capacity;  // Quantidade de nós reservados
+    size_t size_nodes_used;  // Nós já tocados pelo menos uma vez
+    struct mymemory_size_node *size_free_nodes;  // Nós devolvidos, prontos para reuso
+    struct mymemory_size_node *size_root;  // Raiz da árvore (NULL nas demais estratégias)
+    void *mapping;  // Pool persistente: início do arquivo mapeado, onde está esta própria estrutura (NULL = pool comum)
+    size_t mapping_size;  // Pool persistente: tamanho do arquivo mapeado
+    FILE *trace;  // Gravação de trace: uma linha por operação (NULL = desligada)
+    struct mymemory_instrument *instrument;  // Contadores por slot de thread (só compilado com MYMEMORY_INSTRUMENT)
+    uint64_t fl_bitmap;  // Bit i ligado se a classe i tem alguma lista não vazia (Segregated Fit)
+    uint32_t sl_bitmap[MYMEMORY_FL_COUNT];  // Bit j ligado se a lista [i][j] não está vazia
+    allocation_t *segregated[MYMEMORY_FL_COUNT][MYMEMORY_SL_COUNT];  // Listas de blocos livres por classe
 } mymemory_t;
 
 mymemory_t* mymemory_init(size_t size, AllocationStrategy strategy);
+mymemory_t* mymemory_init_config(size_t size, AllocationStrategy strategy, const mymemory_config_t *config);
+mymemory_t* mymemory_open(const char *path, size_t size, AllocationStrategy strategy);
+int mymemory_sync(mymemory_t *memory);
 void* mymemory_alloc(mymemory_t *memory, size_t size);
+void* mymemory_alloc_aligned(mymemory_t *memory, size_t size, size_t alignment);
 void mymemory_free(mymemory_t *memory, void *ptr);
+void* mymemory_realloc(mymemory_t *memory, void *ptr, size_t size);
+void* mymemory_calloc(mymemory_t *memory, size_t count, size_t size);
+size_t mymemory_alloc_batch(mymemory_t *memory, size_t size, size_t count, void **out_ptrs);
+void mymemory_free_batch(mymemory_t *memory, void **ptrs, size_t count);  // O vetor é reordenado e entradas podem virar NULL: o conteúdo não é preservado
+void mymemory_flush(mymemory_t *memory);
+mymemory_marker_t mymemory_mark(mymemory_t *memory);
+void mymemory_rollback(mymemory_t *memory, mymemory_marker_t marker);
+void mymemory_reset(mymemory_t *memory);
+mymemory_handle_t mymemory_halloc(mymemory_t *memory, size_t size);
+void* mymemory_pin(mymemory_t *memory, mymemory_handle_t handle);
+void mymemory_unpin(mymemory_t *memory, mymemory_handle_t handle);
+void mymemory_hfree(mymemory_t *memory, mymemory_handle_t handle);
+int mymemory_compact(mymemory_t *memory, uint64_t budget_ns);
+void mymemory_trace(mymemory_t *memory, FILE *out);
 void mymemory_display(mymemory_t *memory);
 void mymemory_stats(mymemory_t *memory);
+mymemory_stats_t mymemory_get_stats(mymemory_t *memory);
+void mymemory_instrument_dump(mymemory_t *memory, FILE *out);
+int mymemory_walk(mymemory_t *memory, mymemory_extent_cb callback, void *context);
+int mymemory_snapshot(mymemory_t *memory, FILE *out, mymemory_snapshot_format_t format);
 void mymemory_cleanup(mymemory_t *memory);
 
 #endif
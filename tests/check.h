@@ -0,0 +1,18 @@
+// Verificação mínima compartilhada pelos testes: uma condição falsa encerra o teste com o local da falha
+#ifndef MYMEMORY_CHECK_H
+#define MYMEMORY_CHECK_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHECK(cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1); \
+        } \
+    } while (0)
+
+#endif
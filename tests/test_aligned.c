@@ -0,0 +1,80 @@
+// Alocação alinhada: todo bloco respeita o alinhamento pedido e o alinhamento mínimo do pool
+// Alinhamentos que não são potência de 2 são recusados
+#include <stdint.h>
+#include <string.h>
+#include "mymemory.h"
+#include "check.h"
+
+#define LIVE 64
+
+static void run(AllocationStrategy strategy, size_t pool_alignment)
+{
+    mymemory_config_t config = { 0 };
+    config.alignment = pool_alignment;
+    mymemory_t *memory = mymemory_init_config(4 << 20, strategy, &config);
+    size_t minimum = pool_alignment ? pool_alignment : MYMEMORY_GRANULE;
+    void *live[LIVE] = { NULL };
+    unsigned seed = 7u + (unsigned)strategy;
+
+    CHECK(memory);
+    CHECK(mymemory_alloc_aligned(memory, 64, 24) == NULL);
+    CHECK(mymemory_alloc_aligned(memory, 64, 3 * 64) == NULL);
+    CHECK(mymemory_alloc_aligned(memory, 0, 64) == NULL);
+
+    for (int round = 0; round < 2000; round++)
+    {
+        int k = rand_r(&seed) % LIVE;
+        if (live[k] && strategy != ARENA)
+        {
+            mymemory_free(memory, live[k]);
+            live[k] = NULL;
+        }
+        size_t alignment = (size_t)1 << (rand_r(&seed) % 13);  // De 1 a 4096
+        size_t size = 1 + rand_r(&seed) % 600;
+        int aligned = rand_r(&seed) % 4 != 0;
+        void *ptr = aligned ? mymemory_alloc_aligned(memory, size, alignment) : mymemory_alloc(memory, size);
+        if (strategy == ARENA && !ptr) // A arena só recupera espaço no reset
+        {
+            mymemory_reset(memory);
+            memset(live, 0, sizeof(live));
+            continue;
+        }
+        CHECK(ptr);
+        CHECK((uintptr_t)ptr % minimum == 0);
+        CHECK(!aligned || (uintptr_t)ptr % alignment == 0);
+        memset(ptr, 0xab, size);  // O bloco inteiro pertence ao chamador
+        live[k] = ptr;
+    }
+    mymemory_cleanup(memory);
+}
+
+// Cada alinhamento pedido é respeitado; nada é liberado, então cada bloco ocupa espaço novo
+static void exact(AllocationStrategy strategy)
+{
+    mymemory_t *memory = mymemory_init_config(4 << 20, strategy, NULL);
+
+    CHECK(memory);
+    for (size_t alignment = 1; alignment <= 4096; alignment <<= 1)
+    {
+        for (size_t size = 1; size <= 300; size += 37)
+        {
+            void *ptr = mymemory_alloc_aligned(memory, size, alignment);
+            CHECK(ptr);
+            CHECK((uintptr_t)ptr % alignment == 0);
+            CHECK((uintptr_t)ptr % MYMEMORY_GRANULE == 0);
+        }
+    }
+    mymemory_cleanup(memory);
+}
+
+int main(void)
+{
+    for (int strategy = FIRST_FIT; strategy <= BUDDY; strategy++)
+    {
+        run((AllocationStrategy)strategy, 0);
+        run((AllocationStrategy)strategy, MYMEMORY_CACHE_LINE);
+        exact((AllocationStrategy)strategy);
+    }
+    printf("test_aligned: ok\n");
+    return 0;
+}
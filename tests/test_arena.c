@@ -0,0 +1,136 @@
+// Arena: só o início de um objeto abaixo do topo é aceito por free e realloc; rollback, reset e a liberação do
+// último objeto devolvem o espaço, e objetos que deixaram de existir não voltam a ser reconhecidos depois
+#include <string.h>
+#include "mymemory.h"
+#include "check.h"
+
+static void fill(unsigned char *ptr, size_t size, unsigned char seed)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        ptr[i] = (unsigned char)(seed + i * 7);
+    }
+}
+
+static int intact(const unsigned char *ptr, size_t size, unsigned char seed)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        if (ptr[i] != (unsigned char)(seed + i * 7))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Endereços dentro de um objeto, inclusive na sua primeira unidade de alocação, são recusados
+static void interior(void)
+{
+    mymemory_t *memory = mymemory_init_config(1 << 20, ARENA, NULL);
+
+    CHECK(memory);
+    char *a = (char *)mymemory_alloc(memory, 64);
+    char *b = (char *)mymemory_alloc(memory, 64);
+    CHECK(a && b);
+    fill((unsigned char *)b, 64, 3);
+
+    mymemory_free(memory, b + 8);  // Na primeira unidade do último objeto: não o desfaz
+    mymemory_free(memory, b + MYMEMORY_GRANULE);
+    CHECK(mymemory_get_stats(memory).allocated_blocks == 2);
+    CHECK(mymemory_get_stats(memory).bytes_in_use == 128);
+    CHECK(mymemory_realloc(memory, a + 8, 128) == NULL);
+    CHECK(mymemory_realloc(memory, b + 8, 128) == NULL);
+    CHECK(mymemory_realloc(memory, b + 64, 128) == NULL);  // No topo
+    CHECK(mymemory_get_stats(memory).allocated_blocks == 2);
+
+    mymemory_free(memory, b);  // O último objeto volta a ser espaço livre
+    CHECK(mymemory_get_stats(memory).allocated_blocks == 1);
+    CHECK(mymemory_get_stats(memory).bytes_in_use == 64);
+    CHECK(mymemory_alloc(memory, 32) == b);
+    mymemory_cleanup(memory);
+}
+
+// Marcas de objetos desfeitos por rollback, reset ou liberação do último objeto não valem mais
+// quando o topo volta a passar por elas
+static void stale_starts(void)
+{
+    mymemory_t *memory = mymemory_init_config(1 << 20, ARENA, NULL);
+
+    CHECK(memory);
+    char *a = (char *)mymemory_alloc(memory, 64);
+    mymemory_marker_t marker = mymemory_mark(memory);
+    char *b = (char *)mymemory_alloc(memory, 64);
+    char *c = (char *)mymemory_alloc(memory, 64);
+    CHECK(a && b && c);
+    mymemory_rollback(memory, marker);
+    CHECK(mymemory_get_stats(memory).allocated_blocks == 1);
+    CHECK(mymemory_get_stats(memory).bytes_in_use == 64);
+
+    CHECK(mymemory_realloc(memory, a, 256) == a);  // Último objeto: cresce no lugar sobre os antigos "b" e "c"
+    CHECK(mymemory_realloc(memory, b, 32) == NULL);  // "b" agora está dentro de "a"
+    CHECK(mymemory_realloc(memory, c, 32) == NULL);
+
+    fill((unsigned char *)a, 256, 5);
+    char *d = (char *)mymemory_alloc(memory, 16);
+    CHECK(d == a + 256);
+    char *moved = (char *)mymemory_realloc(memory, a, 512);  // Não é o último: é copiado inteiro para o topo
+    CHECK(moved && moved != a);
+    CHECK(intact((unsigned char *)moved, 256, 5));
+
+    mymemory_reset(memory);
+    CHECK(mymemory_get_stats(memory).allocated_blocks == 0);
+    CHECK(mymemory_get_stats(memory).bytes_in_use == 0);
+    char *e = (char *)mymemory_alloc(memory, 1024);  // Cobre todas as marcas antigas
+    CHECK(e == a);
+    CHECK(mymemory_realloc(memory, d, 32) == NULL);
+    CHECK(mymemory_realloc(memory, b, 32) == NULL);
+    fill((unsigned char *)e, 1024, 9);
+    char *f = (char *)mymemory_alloc(memory, 16);
+    CHECK(f == e + 1024);
+    moved = (char *)mymemory_realloc(memory, e, 2048);
+    CHECK(moved && intact((unsigned char *)moved, 1024, 9));
+    mymemory_cleanup(memory);
+}
+
+// Alocações e rollbacks aleatórios: o topo e a contagem de objetos acompanham as marcas
+static void markers(void)
+{
+    mymemory_t *memory = mymemory_init_config(1 << 20, ARENA, NULL);
+    mymemory_marker_t stack[32];
+    size_t tops[32];
+    int depth = 0;
+    unsigned seed = 99;
+
+    CHECK(memory);
+    for (int round = 0; round < 20000; round++)
+    {
+        int action = rand_r(&seed) % 8;
+        if (action == 0 && depth < 32)
+        {
+            tops[depth] = mymemory_get_stats(memory).bytes_in_use;
+            stack[depth++] = mymemory_mark(memory);
+        }
+        else if (action == 1 && depth)
+        {
+            depth--;
+            mymemory_rollback(memory, stack[depth]);
+            CHECK(mymemory_get_stats(memory).bytes_in_use == tops[depth]);
+        }
+        else if (!mymemory_alloc(memory, 1 + rand_r(&seed) % 2000))
+        {
+            mymemory_reset(memory);
+            depth = 0;
+        }
+    }
+    mymemory_cleanup(memory);
+}
+
+int main(void)
+{
+    interior();
+    stale_starts();
+    markers();
+    printf("test_arena: ok\n");
+    return 0;
+}
@@ -0,0 +1,75 @@
+// Lotes: mymemory_alloc_batch entrega blocos distintos que não se sobrepõem, ou nenhum;
+// mymemory_free_batch pula entradas NULL e libera tudo o mais
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mymemory.h"
+#include "check.h"
+
+#define COUNT 200
+
+static int by_address(const void *a, const void *b)
+{
+    uintptr_t x = (uintptr_t)*(void *const *)a, y = (uintptr_t)*(void *const *)b;
+    return (x > y) - (x < y);
+}
+
+static void run(AllocationStrategy strategy)
+{
+    mymemory_t *memory = mymemory_init_config(1 << 20, strategy, NULL);
+    void *ptrs[COUNT];
+    void *sorted[COUNT];
+    char outside[16];
+
+    CHECK(memory);
+    CHECK(mymemory_alloc_batch(memory, 0, COUNT, ptrs) == 0);
+    CHECK(mymemory_alloc_batch(memory, 40, COUNT, ptrs) == COUNT);
+    CHECK(mymemory_get_stats(memory).allocated_blocks == COUNT);
+    memcpy(sorted, ptrs, sizeof(ptrs));
+    qsort(sorted, COUNT, sizeof(void *), by_address);
+    for (int i = 0; i < COUNT; i++)
+    {
+        CHECK((uintptr_t)sorted[i] % MYMEMORY_GRANULE == 0);
+        CHECK(i == 0 || (char *)sorted[i] >= (char *)sorted[i - 1] + 40);  // Distintos e sem sobreposição
+        memset(ptrs[i], i, 40);
+    }
+    for (int i = 0; i < COUNT; i++)
+    {
+        CHECK(((unsigned char *)ptrs[i])[39] == (unsigned char)i);
+    }
+
+    for (int i = 0; i < COUNT; i += 3) // Parte sai uma a uma; no lote, a entrada fica NULL
+    {
+        mymemory_free(memory, ptrs[i]);
+        ptrs[i] = NULL;
+    }
+    void *kept = ptrs[1];
+    ptrs[1] = outside;  // Endereço inválido: recusado sem impedir os demais
+    mymemory_free_batch(memory, ptrs, COUNT);
+    mymemory_stats_t stats = mymemory_get_stats(memory);
+    CHECK(stats.allocated_blocks == 1);  // Só o bloco que estava em ptrs[1]
+    mymemory_free(memory, kept);
+    stats = mymemory_get_stats(memory);
+    CHECK(stats.allocated_blocks == 0);
+    CHECK(stats.bytes_in_use == 0);
+
+    void *big[64];  // Um lote que não cabe não deixa nada alocado
+    CHECK(mymemory_alloc_batch(memory, 64 << 10, 64, big) == 0);
+    stats = mymemory_get_stats(memory);
+    CHECK(stats.allocated_blocks == 0);
+    CHECK(stats.bytes_in_use == 0);
+    mymemory_cleanup(memory);
+}
+
+int main(void)
+{
+    for (int strategy = FIRST_FIT; strategy <= BUDDY; strategy++)
+    {
+        if (strategy != ARENA) // A arena tem o seu próprio teste
+        {
+            run((AllocationStrategy)strategy);
+        }
+    }
+    printf("test_batch: ok\n");
+    return 0;
+}
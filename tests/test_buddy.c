@@ -0,0 +1,68 @@
+// Buddy: cada bloco tem a menor potência de 2 que comporta o pedido e fica alinhado ao próprio tamanho;
+// a fragmentação interna conta o arredondamento, e com tudo liberado os pares se juntam de volta em um só bloco
+#include <stdint.h>
+#include <string.h>
+#include "mymemory.h"
+#include "check.h"
+
+#define POOL_SIZE (4 << 20)  // Potência de 2: o pool inteiro é um único bloco
+#define LIVE 512
+
+static size_t block_size(size_t size)
+{
+    size_t block = MYMEMORY_GRANULE;
+    while (block < size)
+    {
+        block <<= 1;
+    }
+    return block;
+}
+
+int main(void)
+{
+    mymemory_t *memory = mymemory_init_config(POOL_SIZE, BUDDY, NULL);
+    unsigned char *live[LIVE] = { NULL };
+    size_t sizes[LIVE] = { 0 };
+    size_t rounding = 0;  // Soma de (bloco - pedido) dos blocos vivos
+    unsigned seed = 3;
+
+    CHECK(memory);
+    mymemory_stats_t stats = mymemory_get_stats(memory);
+    CHECK(stats.free_blocks == 1 && stats.largest_free_block == POOL_SIZE);
+
+    for (int round = 0; round < 50000; round++)
+    {
+        int k = rand_r(&seed) % LIVE;
+        if (live[k])
+        {
+            CHECK(live[k][0] == (unsigned char)k && live[k][sizes[k] - 1] == (unsigned char)k);
+            mymemory_free(memory, live[k]);
+            rounding -= block_size(sizes[k]) - sizes[k];
+            live[k] = NULL;
+            continue;
+        }
+        size_t size = MYMEMORY_GRANULE * (1 + rand_r(&seed) % (rand_r(&seed) % 16 ? 32 : 1024));  // Pedidos já múltiplos do grânulo
+        live[k] = (unsigned char *)mymemory_alloc(memory, size);
+        CHECK(live[k]);
+        CHECK((size_t)(live[k] - (unsigned char *)memory->pool) % block_size(size) == 0);
+        sizes[k] = size;
+        rounding += block_size(size) - size;
+        memset(live[k], k, size);
+        CHECK(mymemory_get_stats(memory).internal_fragmentation == rounding);
+    }
+
+    for (int k = 0; k < LIVE; k++)
+    {
+        mymemory_free(memory, live[k]);
+    }
+    stats = mymemory_get_stats(memory);
+    CHECK(stats.allocated_blocks == 0);
+    CHECK(stats.internal_fragmentation == 0);
+    CHECK(stats.free_blocks == 1);  // Todos os pares se juntaram
+    CHECK(stats.largest_free_block == POOL_SIZE);
+    CHECK(mymemory_alloc(memory, POOL_SIZE) == memory->pool);
+    CHECK(mymemory_alloc(memory, 1) == NULL);
+    mymemory_cleanup(memory);
+    printf("test_buddy: ok\n");
+    return 0;
+}
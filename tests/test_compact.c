@@ -0,0 +1,110 @@
+// Compactação: os blocos de handles mudam de lugar sem perder o conteúdo, e blocos fixados ficam onde estão
+// Também confere que um handle liberado deixa de valer mesmo depois que sua entrada é reaproveitada
+#include <string.h>
+#include "mymemory.h"
+#include "check.h"
+
+#define HANDLES 400
+
+typedef struct {
+    mymemory_handle_t handle;
+    size_t size;
+} entry_t;
+
+// Byte esperado na posição "i" do bloco do handle "k"
+static unsigned char pattern(int k, size_t i)
+{
+    return (unsigned char)(k * 31 + i * 7);
+}
+
+static void fill(mymemory_t *memory, const entry_t *entry, int k)
+{
+    unsigned char *ptr = (unsigned char *)mymemory_pin(memory, entry->handle);
+    CHECK(ptr);
+    for (size_t i = 0; i < entry->size; i++)
+    {
+        ptr[i] = pattern(k, i);
+    }
+    mymemory_unpin(memory, entry->handle);
+}
+
+static void check_contents(mymemory_t *memory, const entry_t *entry, int k)
+{
+    unsigned char *ptr = (unsigned char *)mymemory_pin(memory, entry->handle);
+    CHECK(ptr);
+    for (size_t i = 0; i < entry->size; i++)
+    {
+        CHECK(ptr[i] == pattern(k, i));
+    }
+    mymemory_unpin(memory, entry->handle);
+}
+
+static void run(AllocationStrategy strategy, uint64_t budget_ns)
+{
+    mymemory_config_t config = { 0 };
+    mymemory_t *memory = mymemory_init_config(1 << 20, strategy, &config);
+    entry_t entries[HANDLES];
+    unsigned seed = 99u + (unsigned)strategy;
+
+    CHECK(memory);
+    for (int k = 0; k < HANDLES; k++)
+    {
+        entries[k].size = 1 + rand_r(&seed) % 1500;
+        entries[k].handle = mymemory_halloc(memory, entries[k].size);
+        CHECK(entries[k].handle);
+        fill(memory, &entries[k], k);
+    }
+    for (int k = 0; k < HANDLES; k += 2) // Buracos entre os blocos que ficam
+    {
+        mymemory_hfree(memory, entries[k].handle);
+        CHECK(!mymemory_pin(memory, entries[k].handle));
+        entries[k].handle = 0;
+    }
+
+    int pinned = HANDLES - 1;  // Um bloco fixado não pode mudar de lugar durante a compactação
+    void *pinned_at = mymemory_pin(memory, entries[pinned].handle);
+    CHECK(pinned_at);
+    while (!mymemory_compact(memory, budget_ns)) // Com orçamento, cada chamada continua de onde a anterior parou
+    {
+    }
+    CHECK(mymemory_pin(memory, entries[pinned].handle) == pinned_at);
+    mymemory_unpin(memory, entries[pinned].handle);
+    mymemory_unpin(memory, entries[pinned].handle);
+
+    for (int k = 1; k < HANDLES; k += 2)
+    {
+        check_contents(memory, &entries[k], k);
+    }
+
+    while (!mymemory_compact(memory, 0)) // Sem fixações, a memória livre fica toda no fim do pool
+    {
+    }
+    mymemory_stats_t stats = mymemory_get_stats(memory);
+    CHECK(stats.free_blocks == 1);
+    CHECK(stats.largest_free_block == stats.bytes_free);
+    for (int k = 1; k < HANDLES; k += 2)
+    {
+        check_contents(memory, &entries[k], k);
+    }
+
+    mymemory_handle_t old = entries[1].handle; // Handles de gerações passadas continuam inválidos
+    mymemory_hfree(memory, old);
+    mymemory_handle_t reused = mymemory_halloc(memory, 64);
+    CHECK(reused && reused != old);
+    CHECK(!mymemory_pin(memory, old));
+    mymemory_hfree(memory, old);  // Não pode liberar o bloco do handle novo
+    CHECK(mymemory_pin(memory, reused));
+    mymemory_unpin(memory, reused);
+    mymemory_cleanup(memory);
+}
+
+int main(void)
+{
+    for (int strategy = FIRST_FIT; strategy <= SEGREGATED_FIT; strategy++)
+    {
+        run((AllocationStrategy)strategy, 0);
+        run((AllocationStrategy)strategy, 1000);
+    }
+    printf("test_compact: ok\n");
+    return 0;
+}
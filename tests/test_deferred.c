@@ -0,0 +1,133 @@
+// Liberações adiadas: os blocos enfileirados por várias threads acabam todos liberados; mymemory_flush é uma barreira,
+// uma alocação sem espaço drena as filas antes de falhar e o reset descarta o que ainda estava nelas
+#include <pthread.h>
+#include <string.h>
+#include "mymemory.h"
+#include "check.h"
+
+#define THREADS 4
+#define SLOTS 128
+#define OPERATIONS 50000
+#define LARGE 4096  // Maior que MYMEMORY_CACHE_MAX_SIZE: sempre volta ao pool compartilhado pela fila
+
+typedef struct {
+    mymemory_t *memory;
+    unsigned seed;
+} worker_t;
+
+static mymemory_t *deferred_pool(AllocationStrategy strategy, size_t size)
+{
+    mymemory_config_t config = { 0 };
+    config.deferred_free = 1;
+    return mymemory_init_config(size, strategy, &config);
+}
+
+static void *worker(void *arg)
+{
+    worker_t *work = (worker_t *)arg;
+    unsigned char *slots[SLOTS] = { NULL };
+
+    for (int i = 0; i < OPERATIONS; i++)
+    {
+        int k = rand_r(&work->seed) % SLOTS;
+        if (slots[k])
+        {
+            CHECK(slots[k][0] == (unsigned char)k);
+            mymemory_free(work->memory, slots[k]);
+            slots[k] = NULL;
+            continue;
+        }
+        size_t size = 16 + rand_r(&work->seed) % (rand_r(&work->seed) % 4 ? 240 : LARGE);
+        slots[k] = (unsigned char *)mymemory_alloc(work->memory, size);
+        CHECK(slots[k]);
+        memset(slots[k], k, size);  // Um bloco ainda na fila não pode ser entregue de novo
+    }
+    for (int k = 0; k < SLOTS; k++)
+    {
+        mymemory_free(work->memory, slots[k]);
+    }
+    return NULL;
+}
+
+// Várias threads liberando ao mesmo tempo que a thread de manutenção drena as filas
+static void threads(AllocationStrategy strategy)
+{
+    mymemory_t *memory = deferred_pool(strategy, 32 << 20);
+    pthread_t ids[THREADS];
+    worker_t work[THREADS];
+
+    CHECK(memory);
+    for (int t = 0; t < THREADS; t++)
+    {
+        work[t].memory = memory;
+        work[t].seed = 17u * (unsigned)(t + 1) + (unsigned)strategy;
+        CHECK(pthread_create(&ids[t], NULL, worker, &work[t]) == 0);
+    }
+    for (int t = 0; t < THREADS; t++)
+    {
+        pthread_join(ids[t], NULL);
+    }
+    mymemory_flush(memory);
+    mymemory_stats_t stats = mymemory_get_stats(memory);
+    CHECK(stats.pending_frees == 0);
+    CHECK(stats.failed_allocations == 0);
+    mymemory_reset(memory);  // Os caches de thread ainda guardam blocos pequenos: o reset devolve tudo
+    stats = mymemory_get_stats(memory);
+    CHECK(stats.allocated_blocks == 0);
+    CHECK(stats.bytes_in_use == 0);
+    mymemory_cleanup(memory);
+}
+
+// Barreira, drenagem antes de falhar e descarte no reset, com blocos que não passam pelos caches de thread
+static void ordering(AllocationStrategy strategy)
+{
+    mymemory_t *memory = deferred_pool(strategy, 1 << 20);
+    void *blocks[64];
+
+    CHECK(memory);
+    for (int i = 0; i < 64; i++)
+    {
+        blocks[i] = mymemory_alloc(memory, LARGE);
+        CHECK(blocks[i]);
+    }
+    for (int i = 0; i < 64; i++)
+    {
+        mymemory_free(memory, blocks[i]);
+    }
+    mymemory_flush(memory);
+    mymemory_stats_t stats = mymemory_get_stats(memory);
+    CHECK(stats.pending_frees == 0);
+    CHECK(stats.allocated_blocks == 0);
+
+    void *big = mymemory_alloc(memory, 768 << 10);  // Ocupa a maior parte do pool
+    CHECK(big);
+    mymemory_free(memory, big);
+    big = mymemory_alloc(memory, 768 << 10);  // Só cabe se a liberação ainda na fila for feita antes
+    CHECK(big);
+    CHECK(mymemory_get_stats(memory).failed_allocations == 0);
+
+    mymemory_free(memory, big);
+    mymemory_reset(memory);  // Descarta a liberação ainda na fila
+    void *again = mymemory_alloc(memory, 768 << 10);
+    CHECK(again);
+    mymemory_flush(memory);  // A liberação descartada não pode liberar o bloco novo no mesmo endereço
+    stats = mymemory_get_stats(memory);
+    CHECK(stats.allocated_blocks == 1);
+    CHECK(stats.pending_frees == 0);
+    mymemory_cleanup(memory);
+}
+
+int main(void)
+{
+    for (int strategy = FIRST_FIT; strategy <= BUDDY; strategy++)
+    {
+        if (strategy == ARENA) // A arena não libera objetos individualmente
+        {
+            continue;
+        }
+        threads((AllocationStrategy)strategy);
+        ordering((AllocationStrategy)strategy);
+    }
+    printf("test_deferred: ok\n");
+    return 0;
+}
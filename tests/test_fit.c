@@ -0,0 +1,73 @@
+// Escolha do bloco na árvore por tamanho: Best e Worst Fit precisam escolher o mesmo trecho que uma busca linear
+// nos trechos livres do percurso do pool, também em pedidos alinhados
+#include <stdint.h>
+#include <string.h>
+#include "mymemory.h"
+#include "check.h"
+
+#define LIVE 600
+#define ROUNDS 30000
+
+typedef struct {
+    AllocationStrategy strategy;
+    size_t size;  // Pedido já arredondado para a unidade de alocação
+    size_t alignment;
+    char *chosen;  // Onde o bloco deveria começar (NULL = nenhum trecho comporta)
+    size_t chosen_size;  // Tamanho do trecho escolhido
+} scan_t;
+
+// Busca linear: Best Fit fica com o menor trecho que comporta o pedido já alinhado; Worst Fit, com o maior
+// Entre trechos do mesmo tamanho, vence o de menor endereço (o percurso vem em ordem de endereços)
+static int scan_extent(const mymemory_extent_t *extent, void *context)
+{
+    scan_t *scan = (scan_t *)context;
+    char *start = (char *)(((uintptr_t)extent->start + scan->alignment - 1) & ~(uintptr_t)(scan->alignment - 1));
+    size_t padding = (size_t)(start - (char *)extent->start);
+    if (!extent->is_free || extent->size < padding || extent->size - padding < scan->size)
+    {
+        return 0;
+    }
+    if (!scan->chosen ||
+        (scan->strategy == BEST_FIT && extent->size < scan->chosen_size) ||
+        (scan->strategy == WORST_FIT && extent->size > scan->chosen_size))
+    {
+        scan->chosen = start;
+        scan->chosen_size = extent->size;
+    }
+    return 0;
+}
+
+static void run(AllocationStrategy strategy)
+{
+    mymemory_t *memory = mymemory_init_config(1 << 20, strategy, NULL);
+    void *live[LIVE] = { NULL };
+    unsigned seed = 4321u + (unsigned)strategy;
+
+    CHECK(memory);
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        int k = rand_r(&seed) % LIVE;
+        if (live[k])
+        {
+            mymemory_free(memory, live[k]);
+            live[k] = NULL;
+            continue;
+        }
+
+        size_t size = rand_r(&seed) % 8 ? 1 + rand_r(&seed) % 512 : 1 + rand_r(&seed) % 8192;
+        size_t alignment = rand_r(&seed) % 4 ? MYMEMORY_GRANULE : (size_t)MYMEMORY_GRANULE << (1 + rand_r(&seed) % 5);
+        scan_t scan = { strategy, (size + MYMEMORY_GRANULE - 1) & ~(size_t)(MYMEMORY_GRANULE - 1), alignment, NULL, 0 };
+        mymemory_walk(memory, scan_extent, &scan);
+        live[k] = mymemory_alloc_aligned(memory, size, alignment);
+        CHECK((char *)live[k] == scan.chosen);  // O bloco novo começa no trecho escolhido pela busca linear
+    }
+    mymemory_cleanup(memory);
+}
+
+int main(void)
+{
+    run(BEST_FIT);
+    run(WORST_FIT);
+    printf("test_fit: ok\n");
+    return 0;
+}
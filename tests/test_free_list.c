@@ -0,0 +1,86 @@
+// Lista de livres em ordem de endereços com fusão imediata: o pool nunca tem dois trechos livres vizinhos
+// e, com tudo liberado (em qualquer ordem), volta a ser um único trecho livre
+#include "mymemory.h"
+#include "check.h"
+
+#define POOL_SIZE (1 << 20)
+#define LIVE 512
+#define ROUNDS 20000
+
+typedef struct {
+    char *next;  // Onde o próximo trecho precisa começar
+    int last_free;  // O trecho anterior estava livre
+    size_t free_extents;
+    size_t request;  // Pedido arredondado: o primeiro trecho livre que o comporta vai para "first_fit"
+    char *first_fit;
+} walk_t;
+
+static int walk_extent(const mymemory_extent_t *extent, void *context)
+{
+    walk_t *walk = (walk_t *)context;
+    CHECK((char *)extent->start == walk->next);  // Trechos contíguos, em ordem de endereços
+    CHECK(!(extent->is_free && walk->last_free));  // Livres vizinhos sempre são fundidos
+    if (extent->is_free)
+    {
+        walk->free_extents++;
+        if (!walk->first_fit && extent->size >= walk->request)
+        {
+            walk->first_fit = (char *)extent->start;
+        }
+    }
+    walk->last_free = extent->is_free;
+    walk->next = (char *)extent->start + extent->size;
+    return 0;
+}
+
+static walk_t check_pool(mymemory_t *memory, size_t request)
+{
+    walk_t walk = { (char *)memory->pool, 0, 0, request, NULL };
+    CHECK(mymemory_walk(memory, walk_extent, &walk) == 0);
+    CHECK(walk.next == (char *)memory->pool + memory->total_size);  // O percurso cobre o pool inteiro
+    return walk;
+}
+
+static void run(AllocationStrategy strategy)
+{
+    mymemory_config_t config = { 0 };
+    mymemory_t *memory = mymemory_init_config(POOL_SIZE, strategy, &config);
+    void *live[LIVE] = { NULL };
+    unsigned seed = 2024u + (unsigned)strategy;
+
+    CHECK(memory);
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        int k = rand_r(&seed) % LIVE;
+        if (live[k])
+        {
+            mymemory_free(memory, live[k]);
+            live[k] = NULL;
+            continue;
+        }
+        size_t size = rand_r(&seed) % 8 ? 1 + rand_r(&seed) % 512 : 1 + rand_r(&seed) % 8192;
+        walk_t walk = check_pool(memory, (size + MYMEMORY_GRANULE - 1) & ~(size_t)(MYMEMORY_GRANULE - 1));
+        live[k] = mymemory_alloc(memory, size);
+        if (strategy == FIRST_FIT) // First Fit: o trecho livre de menor endereço que comporta o pedido
+        {
+            CHECK((char *)live[k] == walk.first_fit);
+        }
+    }
+
+    for (int i = 0; i < LIVE; i++) // Libera na ordem do vetor, que não é a de endereços
+    {
+        mymemory_free(memory, live[i]);
+    }
+    CHECK(check_pool(memory, 0).free_extents == 1);
+    mymemory_cleanup(memory);
+}
+
+int main(void)
+{
+    run(FIRST_FIT);
+    run(BEST_FIT);
+    run(WORST_FIT);
+    run(SEGREGATED_FIT);
+    printf("test_free_list: ok\n");
+    return 0;
+}
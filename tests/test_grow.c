@@ -0,0 +1,82 @@
+// Pool crescente: uma reserva grande (16 GiB) começa com poucas regiões habilitadas, cresce sob demanda sem mudar
+// de endereço e devolve ao sistema as regiões que ficam inteiramente livres
+#include <stdint.h>
+#include <string.h>
+#include "mymemory.h"
+#include "check.h"
+
+#define BLOCKS 48
+#define BLOCK_SIZE (1 << 20)
+
+static mymemory_t *grow_pool(AllocationStrategy strategy)
+{
+    mymemory_config_t config = { 0 };
+    config.max_size = (size_t)16 << 30;
+    return mymemory_init_config(1 << 20, strategy, &config);
+}
+
+static void run(AllocationStrategy strategy)
+{
+    mymemory_t *memory = grow_pool(strategy);
+    char *blocks[BLOCKS];
+
+    CHECK(memory);
+    char *pool = (char *)memory->pool;
+    mymemory_stats_t stats = mymemory_get_stats(memory);
+    CHECK(stats.total_size == MYMEMORY_REGION_SIZE);  // Só o tamanho inicial, arredondado para regiões inteiras
+    CHECK(stats.resident_size <= stats.total_size);
+
+    mymemory_marker_t marker = mymemory_mark(memory);
+    for (int i = 0; i < BLOCKS; i++)
+    {
+        blocks[i] = (char *)mymemory_alloc(memory, BLOCK_SIZE);
+        CHECK(blocks[i]);
+        memset(blocks[i], i, BLOCK_SIZE);
+        CHECK((char *)memory->pool == pool);  // Crescer não muda o pool de lugar
+        CHECK(blocks[i] >= pool && blocks[i] + BLOCK_SIZE <= pool + memory->total_size);
+    }
+    stats = mymemory_get_stats(memory);
+    CHECK(stats.total_size >= (size_t)BLOCKS * BLOCK_SIZE);
+    CHECK(stats.total_size < (size_t)1 << 30);  // Cresceu só o necessário
+    CHECK(stats.resident_size >= (size_t)BLOCKS * BLOCK_SIZE);
+    for (int i = 0; i < BLOCKS; i++)
+    {
+        CHECK(blocks[i][0] == i && blocks[i][BLOCK_SIZE - 1] == i);
+    }
+
+    if (strategy == ARENA)
+    {
+        mymemory_rollback(memory, marker);
+    }
+    else
+    {
+        for (int i = 0; i < BLOCKS; i++)
+        {
+            mymemory_free(memory, blocks[i]);
+        }
+    }
+    stats = mymemory_get_stats(memory);
+    CHECK(stats.bytes_in_use == 0);
+    CHECK(stats.resident_size <= MYMEMORY_REGION_SIZE);  // As regiões livres voltaram ao sistema
+
+    CHECK(mymemory_alloc(memory, ((size_t)16 << 30) + 1) == NULL);  // Maior que a reserva
+    CHECK(mymemory_alloc(memory, 64) != NULL);  // As regiões devolvidas continuam utilizáveis
+    mymemory_cleanup(memory);
+}
+
+int main(void)
+{
+    for (int strategy = FIRST_FIT; strategy <= ARENA; strategy++)
+    {
+        run((AllocationStrategy)strategy);
+    }
+    for (int strategy = SLAB; strategy <= BUDDY; strategy++) // Slab e Buddy não crescem: o pool tem o tamanho inicial
+    {
+        mymemory_t *memory = grow_pool((AllocationStrategy)strategy);
+        CHECK(memory);
+        CHECK(memory->total_size == 1 << 20 && memory->max_size == 1 << 20);
+        mymemory_cleanup(memory);
+    }
+    printf("test_grow: ok\n");
+    return 0;
+}
@@ -0,0 +1,90 @@
+// Modo de depuração: liberação dupla, endereço inválido, zona de guarda sobrescrita e escrita depois da liberação são
+// detectados, contados em guard_errors e relatados em stderr, sem derrubar o programa nem estragar o pool
+#include <string.h>
+#include <unistd.h>
+#include "mymemory.h"
+#include "check.h"
+
+static FILE *captured;  // Recebe o stderr enquanto os erros são provocados
+static int saved_stderr;
+
+static void capture_begin(void)
+{
+    fflush(stderr);
+    captured = tmpfile();
+    CHECK(captured);
+    saved_stderr = dup(STDERR_FILENO);
+    dup2(fileno(captured), STDERR_FILENO);
+}
+
+// Devolve o stderr e retorna quantas linhas foram relatadas
+static int capture_end(void)
+{
+    int lines = 0, c;
+
+    fflush(stderr);
+    dup2(saved_stderr, STDERR_FILENO);
+    close(saved_stderr);
+    rewind(captured);
+    while ((c = fgetc(captured)) != EOF)
+    {
+        lines += c == '\n';
+    }
+    fclose(captured);
+    return lines;
+}
+
+static void run(AllocationStrategy strategy)
+{
+    mymemory_config_t config = { 0 };
+    config.harden = 1;
+    mymemory_t *memory = mymemory_init_config(1 << 20, strategy, &config);
+
+    CHECK(memory);
+    unsigned char *keep = (unsigned char *)mymemory_alloc(memory, 40);
+    unsigned char *a = (unsigned char *)mymemory_alloc(memory, 32);
+    unsigned char *b = (unsigned char *)mymemory_alloc(memory, 20);
+    unsigned char *c = (unsigned char *)mymemory_alloc(memory, 100);
+    CHECK(keep && a && b && c);
+    memset(keep, 0x5A, 40);
+
+    capture_begin();
+    mymemory_free(memory, a);
+    mymemory_free(memory, a);  // Liberação dupla
+    mymemory_free(memory, keep + 16);  // Não é o início de um bloco
+    void *moved = mymemory_realloc(memory, a, 64);  // Realocação de bloco já liberado
+    b[20] = 0;  // Um byte depois do tamanho pedido
+    mymemory_free(memory, b);
+    mymemory_free(memory, c);
+    int poisoned = c[0] == 0xDD && c[63] == 0xDD;  // Na quarentena, o início do bloco liberado fica envenenado
+    c[0] = 1;  // Escrita depois da liberação: aparece quando o bloco sai da quarentena
+    for (int i = 0; i < 2 * MYMEMORY_QUARANTINE; i++)
+    {
+        mymemory_free(memory, mymemory_alloc(memory, 48));
+    }
+    int lines = capture_end();
+
+    CHECK(moved == NULL);
+    CHECK(poisoned);
+    mymemory_stats_t stats = mymemory_get_stats(memory);
+    CHECK(stats.guard_errors == 5);
+    CHECK(lines == 5);  // Um relato por erro
+    CHECK(stats.allocated_blocks == 1 + MYMEMORY_QUARANTINE);  // "keep", intacto, e a quarentena cheia, que conta como alocada
+    for (int i = 0; i < 40; i++)
+    {
+        CHECK(keep[i] == 0x5A);
+    }
+    mymemory_free(memory, keep);
+    CHECK(mymemory_get_stats(memory).guard_errors == 5);  // Uso correto não relata nada
+    mymemory_cleanup(memory);
+}
+
+int main(void)
+{
+    for (int strategy = FIRST_FIT; strategy <= SEGREGATED_FIT; strategy++)
+    {
+        run((AllocationStrategy)strategy);
+    }
+    printf("test_harden: ok\n");
+    return 0;
+}
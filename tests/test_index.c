@@ -0,0 +1,53 @@
+// Índice de blocos alocados: mymemory_free só aceita o início exato de um bloco alocado
+// Endereços internos, de fora do pool e liberações duplas são recusados sem mexer no pool
+#include "mymemory.h"
+#include "check.h"
+
+static void run(AllocationStrategy strategy)
+{
+    mymemory_t *memory = mymemory_init_config(1 << 20, strategy, NULL);
+    char outside[32];
+    char *blocks[64];
+
+    CHECK(memory);
+    for (int i = 0; i < 64; i++)
+    {
+        blocks[i] = (char *)mymemory_alloc(memory, 16 + (size_t)i * 24);
+        CHECK(blocks[i]);
+    }
+    mymemory_stats_t before = mymemory_get_stats(memory);
+
+    mymemory_free(memory, blocks[10] + 16);  // Dentro de um bloco
+    mymemory_free(memory, blocks[10] - 16);  // Dentro do bloco anterior
+    mymemory_free(memory, outside);  // Fora do pool
+    mymemory_free(memory, (char *)memory->pool + memory->total_size);  // Logo depois do fim
+    mymemory_stats_t after = mymemory_get_stats(memory);
+    CHECK(after.allocated_blocks == before.allocated_blocks);
+    CHECK(after.bytes_in_use == before.bytes_in_use);
+
+    mymemory_free(memory, blocks[20]);
+    mymemory_free(memory, blocks[20]);  // Liberação dupla
+    after = mymemory_get_stats(memory);
+    CHECK(after.allocated_blocks == before.allocated_blocks - 1);
+
+    for (int i = 0; i < 64; i++) // Cada bloco restante ainda é encontrado pelo índice
+    {
+        if (i != 20)
+        {
+            mymemory_free(memory, blocks[i]);
+        }
+    }
+    after = mymemory_get_stats(memory);
+    CHECK(after.allocated_blocks == 0);
+    CHECK(after.bytes_in_use == 0);
+    mymemory_cleanup(memory);
+}
+
+int main(void)
+{
+    run(FIRST_FIT);
+    run(BEST_FIT);
+    run(WORST_FIT);
+    printf("test_index: ok\n");
+    return 0;
+}
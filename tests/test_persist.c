@@ -0,0 +1,119 @@
+// Pool persistente: o que foi alocado e gravado antes de fechar o arquivo volta igual na reabertura, com os mesmos
+// deslocamentos e contadores, e o pool reaberto continua utilizável; arquivos de outro pool são recusados
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "mymemory.h"
+#include "check.h"
+
+#define POOL_SIZE (1 << 20)
+#define BLOCKS 100
+
+static void run(AllocationStrategy strategy)
+{
+    char path[] = "/tmp/test_persist_XXXXXX";
+    int fd = mkstemp(path);  // Arquivo vazio: mymemory_open cria o pool
+    size_t offsets[BLOCKS];
+
+    CHECK(fd >= 0);
+    close(fd);
+    mymemory_t *memory = mymemory_open(path, POOL_SIZE, strategy);
+    CHECK(memory);
+    for (int i = 0; i < BLOCKS; i++)
+    {
+        size_t size = 16 + (size_t)i * 8;
+        char *ptr = (char *)mymemory_alloc(memory, size);
+        CHECK(ptr);
+        memset(ptr, i, size);
+        offsets[i] = (size_t)(ptr - (char *)memory->pool);
+    }
+    if (strategy != ARENA)
+    {
+        for (int i = 0; i < BLOCKS; i += 4) // Deixa buracos livres no meio do pool
+        {
+            mymemory_free(memory, (char *)memory->pool + offsets[i]);
+        }
+    }
+    mymemory_stats_t before = mymemory_get_stats(memory);
+    CHECK(mymemory_sync(memory) == 0);
+    mymemory_cleanup(memory);
+
+    CHECK(mymemory_open(path, POOL_SIZE * 2, strategy) == NULL);  // Outro tamanho
+    CHECK(mymemory_open(path, POOL_SIZE, strategy == FIRST_FIT ? BEST_FIT : FIRST_FIT) == NULL);  // Outra estratégia
+
+    memory = mymemory_open(path, POOL_SIZE, strategy);
+    CHECK(memory);
+    mymemory_stats_t after = mymemory_get_stats(memory);
+    CHECK(after.bytes_in_use == before.bytes_in_use);
+    CHECK(after.allocated_blocks == before.allocated_blocks);
+    CHECK(after.free_blocks == before.free_blocks);
+    CHECK(after.largest_free_block == before.largest_free_block);
+    for (int i = 0; i < BLOCKS; i++)
+    {
+        if (strategy == ARENA || i % 4)
+        {
+            const char *ptr = (char *)memory->pool + offsets[i];
+            size_t size = 16 + (size_t)i * 8;
+            CHECK(ptr[0] == i && ptr[size - 1] == i);
+        }
+    }
+
+    if (strategy != ARENA) // Os blocos reabertos continuam sendo reconhecidos pelo índice
+    {
+        mymemory_free(memory, (char *)memory->pool + offsets[1]);
+        CHECK(mymemory_get_stats(memory).allocated_blocks == before.allocated_blocks - 1);
+        mymemory_free(memory, (char *)memory->pool + offsets[1]);  // Liberação dupla continua recusada
+        CHECK(mymemory_get_stats(memory).allocated_blocks == before.allocated_blocks - 1);
+    }
+    char *ptr = (char *)mymemory_alloc(memory, 64);
+    CHECK(ptr);
+    CHECK(ptr >= (char *)memory->pool && ptr + 64 <= (char *)memory->pool + POOL_SIZE);
+    mymemory_cleanup(memory);
+
+    fd = open(path, O_WRONLY);  // Cabeçalho estragado: o arquivo não é mais reconhecido
+    CHECK(fd >= 0);
+    CHECK(pwrite(fd, "XXXX", 4, 0) == 4);
+    close(fd);
+    CHECK(mymemory_open(path, POOL_SIZE, strategy) == NULL);
+    unlink(path);
+}
+
+// Arena: as marcas de início deixadas acima do topo por um rollback continuam sendo apagadas depois da reabertura
+static void arena_rollback(void)
+{
+    char path[] = "/tmp/test_persist_XXXXXX";
+    int fd = mkstemp(path);
+
+    CHECK(fd >= 0);
+    close(fd);
+    mymemory_t *memory = mymemory_open(path, POOL_SIZE, ARENA);
+    CHECK(memory);
+    char *a = (char *)mymemory_alloc(memory, 64);
+    mymemory_marker_t marker = mymemory_mark(memory);
+    char *b = (char *)mymemory_alloc(memory, 64);
+    CHECK(a && b);
+    size_t offset_b = (size_t)(b - a);
+    mymemory_rollback(memory, marker);
+    CHECK(mymemory_sync(memory) == 0);
+    mymemory_cleanup(memory);
+
+    memory = mymemory_open(path, POOL_SIZE, ARENA);
+    CHECK(memory);
+    a = (char *)memory->pool;
+    CHECK(mymemory_realloc(memory, a, 256) == a);  // Cresce no lugar sobre o antigo "b"
+    CHECK(mymemory_realloc(memory, a + offset_b, 32) == NULL);  // "b" agora está dentro de "a"
+    mymemory_cleanup(memory);
+    unlink(path);
+}
+
+int main(void)
+{
+    for (int strategy = FIRST_FIT; strategy <= BUDDY; strategy++)
+    {
+        run((AllocationStrategy)strategy);
+    }
+    arena_rollback();
+    printf("test_persist: ok\n");
+    return 0;
+}
@@ -0,0 +1,104 @@
+// mymemory_realloc: o conteúdo sobrevive a qualquer mudança de tamanho; nas estratégias de lista de livres,
+// encolher e crescer sobre o vizinho livre seguinte mantêm o endereço
+#include <string.h>
+#include "mymemory.h"
+#include "check.h"
+
+#define LIVE 128
+
+static void fill(unsigned char *ptr, size_t size, unsigned char seed)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        ptr[i] = (unsigned char)(seed + i * 31);
+    }
+}
+
+static int intact(const unsigned char *ptr, size_t size, unsigned char seed)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        if (ptr[i] != (unsigned char)(seed + i * 31))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Realocações aleatórias: cada bloco guarda um padrão que precisa sobreviver à mudança de tamanho
+static void contents(AllocationStrategy strategy)
+{
+    mymemory_t *memory = mymemory_init_config(8 << 20, strategy, NULL);
+    unsigned char *live[LIVE] = { NULL };
+    size_t sizes[LIVE] = { 0 };
+    unsigned seed = 11u + (unsigned)strategy;
+
+    CHECK(memory);
+    for (int round = 0; round < 20000; round++)
+    {
+        int k = rand_r(&seed) % LIVE;
+        size_t size = 1 + rand_r(&seed) % (rand_r(&seed) % 8 ? 256 : 8192);
+        unsigned char *moved = (unsigned char *)mymemory_realloc(memory, live[k], size);  // NULL vira alocação
+        CHECK(moved);
+        CHECK(intact(moved, sizes[k] < size ? sizes[k] : size, (unsigned char)k));
+        live[k] = moved;
+        sizes[k] = size;
+        fill(moved, size, (unsigned char)k);
+    }
+    for (int k = 0; k < LIVE; k++)
+    {
+        CHECK(intact(live[k], sizes[k], (unsigned char)k));
+        CHECK(mymemory_realloc(memory, live[k], 0) == NULL);  // Tamanho 0 vira liberação
+    }
+    CHECK(mymemory_get_stats(memory).allocated_blocks == 0);
+    mymemory_cleanup(memory);
+}
+
+// Encolher e crescer sobre o vizinho livre não movem o bloco
+static void in_place(AllocationStrategy strategy)
+{
+    mymemory_t *memory = mymemory_init_config(1 << 20, strategy, NULL);
+
+    CHECK(memory);
+    unsigned char *a = (unsigned char *)mymemory_alloc(memory, 256);
+    void *b = mymemory_alloc(memory, 512);
+    void *c = mymemory_alloc(memory, 64);  // Impede que "b" se junte ao resto do pool
+    CHECK(a && b && c);
+    CHECK((char *)b == (char *)a + 256);
+    fill(a, 256, 1);
+
+    mymemory_free(memory, b);
+    CHECK(mymemory_realloc(memory, a, 700) == a);  // Ocupa parte do vizinho livre
+    CHECK(intact(a, 256, 1));
+    CHECK(mymemory_realloc(memory, a, 768) == a);  // Ocupa o que sobrou dele
+    CHECK(mymemory_realloc(memory, a, 128) == a);  // Devolve o final para a lista de livres
+    CHECK(intact(a, 128, 1));
+    CHECK(mymemory_get_stats(memory).bytes_in_use == 128 + 64);
+
+    void *tail = mymemory_alloc(memory, 640);
+    CHECK(tail);
+    if (strategy == FIRST_FIT || strategy == BEST_FIT) // O final devolvido voltou a ser um único trecho livre, do tamanho exato
+    {
+        CHECK(tail == (char *)a + 128);
+    }
+    CHECK(mymemory_realloc(memory, a, 1024) != a);  // Sem vizinho livre: muda de lugar
+    mymemory_cleanup(memory);
+}
+
+int main(void)
+{
+    for (int strategy = FIRST_FIT; strategy <= BUDDY; strategy++)
+    {
+        if (strategy != ARENA) // A arena tem o seu próprio teste
+        {
+            contents((AllocationStrategy)strategy);
+        }
+    }
+    for (int strategy = FIRST_FIT; strategy <= SEGREGATED_FIT; strategy++)
+    {
+        in_place((AllocationStrategy)strategy);
+    }
+    printf("test_realloc: ok\n");
+    return 0;
+}
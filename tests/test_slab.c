@@ -0,0 +1,90 @@
+// Slab: objetos pequenos alinhados ao tamanho da sua classe e agrupados em páginas por classe; objetos grandes em
+// páginas inteiras; páginas esvaziadas voltam a ser livres, exceto a última de cada classe
+#include <stdint.h>
+#include <string.h>
+#include "mymemory.h"
+#include "check.h"
+
+#define LIVE 512
+
+static size_t class_size(size_t size)
+{
+    size_t object = MYMEMORY_GRANULE;
+    while (object < size)
+    {
+        object <<= 1;
+    }
+    return object;
+}
+
+static void objects(void)
+{
+    mymemory_t *memory = mymemory_init_config(8 << 20, SLAB, NULL);
+    unsigned char *live[LIVE] = { NULL };
+    size_t sizes[LIVE] = { 0 };
+    unsigned seed = 5;
+
+    CHECK(memory);
+    for (int round = 0; round < 50000; round++)
+    {
+        int k = rand_r(&seed) % LIVE;
+        if (live[k])
+        {
+            CHECK(live[k][0] == (unsigned char)k && live[k][sizes[k] - 1] == (unsigned char)k);  // Nenhum vizinho escreveu aqui
+            mymemory_free(memory, live[k]);
+            live[k] = NULL;
+            continue;
+        }
+        size_t size = 1 + rand_r(&seed) % (rand_r(&seed) % 16 ? MYMEMORY_SLAB_MAX_SIZE : 3 * MYMEMORY_SLAB_PAGE);
+        live[k] = (unsigned char *)mymemory_alloc(memory, size);
+        CHECK(live[k]);
+        size_t expected = size <= MYMEMORY_SLAB_MAX_SIZE ? class_size(size) : MYMEMORY_SLAB_PAGE;
+        CHECK((uintptr_t)live[k] % expected == 0);
+        sizes[k] = size;
+        memset(live[k], k, size);
+    }
+    for (int k = 0; k < LIVE; k++)
+    {
+        mymemory_free(memory, live[k]);
+    }
+    mymemory_stats_t stats = mymemory_get_stats(memory);
+    CHECK(stats.allocated_blocks == 0);
+    CHECK(stats.bytes_in_use == 0);
+    CHECK(stats.bytes_free == stats.total_size);
+    // Cada classe fica com no máximo uma página vazia, que separa no máximo duas sequências de páginas livres;
+    // as demais voltaram a ser livres e se juntaram às vizinhas
+    CHECK(stats.free_blocks <= MYMEMORY_SLAB_CLASSES + 1);
+    mymemory_cleanup(memory);
+}
+
+// Os objetos de uma classe enchem uma página antes de começar outra
+static void pages(void)
+{
+    mymemory_t *memory = mymemory_init_config(16 * MYMEMORY_SLAB_PAGE, SLAB, NULL);
+    void *small[MYMEMORY_SLAB_PAGE / 64];
+
+    CHECK(memory);
+    for (size_t i = 0; i < MYMEMORY_SLAB_PAGE / 64; i++)
+    {
+        small[i] = mymemory_alloc(memory, 64);
+        CHECK(small[i]);
+        CHECK((uintptr_t)small[i] / MYMEMORY_SLAB_PAGE == (uintptr_t)small[0] / MYMEMORY_SLAB_PAGE);
+    }
+    void *big = mymemory_alloc(memory, 15 * MYMEMORY_SLAB_PAGE);  // Todas as outras páginas
+    CHECK(big);
+    CHECK(mymemory_alloc(memory, 64) == NULL);  // A página da classe está cheia e não há página livre
+    CHECK(mymemory_alloc(memory, 16) == NULL);
+    mymemory_free(memory, small[7]);
+    CHECK(mymemory_alloc(memory, 64) == small[7]);  // A posição liberada volta a ser usada
+    mymemory_free(memory, big);
+    CHECK(mymemory_alloc(memory, 16) != NULL);
+    mymemory_cleanup(memory);
+}
+
+int main(void)
+{
+    objects();
+    pages();
+    printf("test_slab: ok\n");
+    return 0;
+}
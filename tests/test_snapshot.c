@@ -0,0 +1,149 @@
+// Snapshots do pool: os formatos CSV, binário e JSON gravam exatamente os trechos que mymemory_walk percorre;
+// o percurso para no primeiro callback que retorna um valor diferente de 0 e o devolve
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mymemory.h"
+#include "check.h"
+
+#define MAX_EXTENTS 4096
+
+typedef struct {
+    uint64_t offset;
+    uint64_t size;
+    int is_free;
+} record_t;
+
+typedef struct {
+    char *pool;
+    record_t records[MAX_EXTENTS];
+    size_t count;
+    size_t stop_at;  // Trecho em que o percurso é interrompido (0 = nunca)
+} collect_t;
+
+static int collect(const mymemory_extent_t *extent, void *context)
+{
+    collect_t *walk = (collect_t *)context;
+    CHECK(walk->count < MAX_EXTENTS);
+    walk->records[walk->count].offset = (uint64_t)((char *)extent->start - walk->pool);
+    walk->records[walk->count].size = extent->size;
+    walk->records[walk->count].is_free = extent->is_free;
+    walk->count++;
+    return walk->count == walk->stop_at ? 7 : 0;
+}
+
+static void check_csv(mymemory_t *memory, const collect_t *walk)
+{
+    FILE *file = tmpfile();
+    char line[128];
+    unsigned long offset, size;
+    int is_free;
+
+    CHECK(file);
+    CHECK(mymemory_snapshot(memory, file, MYMEMORY_SNAPSHOT_CSV) == 0);
+    rewind(file);
+    CHECK(fgets(line, sizeof(line), file) && strcmp(line, "offset,size,free\n") == 0);
+    for (size_t i = 0; i < walk->count; i++)
+    {
+        CHECK(fscanf(file, "%lu,%lu,%d\n", &offset, &size, &is_free) == 3);
+        CHECK(offset == walk->records[i].offset && size == walk->records[i].size && is_free == walk->records[i].is_free);
+    }
+    CHECK(fgetc(file) == EOF);  // Nenhuma linha a mais
+    fclose(file);
+}
+
+static void check_binary(mymemory_t *memory, const collect_t *walk)
+{
+    FILE *file = tmpfile();
+    uint32_t header[2];
+    uint64_t pool_info[2], record[2];
+
+    CHECK(file);
+    CHECK(mymemory_snapshot(memory, file, MYMEMORY_SNAPSHOT_BINARY) == 0);
+    CHECK((size_t)ftell(file) == 24 + 16 * walk->count);
+    rewind(file);
+    CHECK(fread(header, sizeof(header), 1, file) == 1 && fread(pool_info, sizeof(pool_info), 1, file) == 1);
+    CHECK(memcmp(header, "MYMS", 4) == 0 && header[1] == 1);
+    CHECK(pool_info[0] == (uint64_t)memory->strategy && pool_info[1] == memory->total_size);
+    for (size_t i = 0; i < walk->count; i++)
+    {
+        CHECK(fread(record, sizeof(record), 1, file) == 1);
+        CHECK(record[0] == walk->records[i].offset);
+        CHECK(record[1] >> 1 == walk->records[i].size && (int)(record[1] & 1) == walk->records[i].is_free);
+    }
+    fclose(file);
+}
+
+static void check_json(mymemory_t *memory, const collect_t *walk)
+{
+    FILE *file = tmpfile();
+    char line[256];
+    size_t extents = 0;
+
+    CHECK(file);
+    CHECK(mymemory_snapshot(memory, file, MYMEMORY_SNAPSHOT_JSON) == 0);
+    rewind(file);
+    CHECK(fgets(line, sizeof(line), file) && strncmp(line, "{\"strategy\":\"", 13) == 0);
+    while (fgets(line, sizeof(line), file)) // Um trecho por linha
+    {
+        extents += strncmp(line, "{\"offset\":", 10) == 0;
+    }
+    CHECK(extents == walk->count);
+    CHECK(strcmp(line, "]}\n") == 0);
+    fclose(file);
+}
+
+static void run(AllocationStrategy strategy)
+{
+    mymemory_t *memory = mymemory_init_config(1 << 20, strategy, NULL);
+    static collect_t walk;
+    void *live[256] = { NULL };
+    unsigned seed = 31u + (unsigned)strategy;
+
+    CHECK(memory);
+    for (int round = 0; round < 2000; round++) // Um pool com trechos livres e alocados misturados
+    {
+        int k = rand_r(&seed) % 256;
+        if (live[k] && strategy != ARENA)
+        {
+            mymemory_free(memory, live[k]);
+            live[k] = NULL;
+        }
+        else if (!live[k])
+        {
+            live[k] = mymemory_alloc(memory, 1 + rand_r(&seed) % 2000);
+        }
+    }
+
+    memset(&walk, 0, sizeof(walk));
+    walk.pool = (char *)memory->pool;
+    CHECK(mymemory_walk(memory, collect, &walk) == 0);
+    CHECK(walk.count > 1);
+    check_csv(memory, &walk);
+    check_binary(memory, &walk);
+    check_json(memory, &walk);
+
+    collect_t *stopped = (collect_t *)calloc(1, sizeof(collect_t));  // Percurso interrompido no segundo trecho
+    CHECK(stopped);
+    stopped->pool = (char *)memory->pool;
+    stopped->stop_at = 2;
+    CHECK(mymemory_walk(memory, collect, stopped) == 7);
+    CHECK(stopped->count == 2);
+    free(stopped);
+
+    FILE *file = tmpfile();
+    CHECK(file);
+    CHECK(mymemory_snapshot(memory, file, (mymemory_snapshot_format_t)99) == -1);
+    fclose(file);
+    mymemory_cleanup(memory);
+}
+
+int main(void)
+{
+    for (int strategy = FIRST_FIT; strategy <= BUDDY; strategy++)
+    {
+        run((AllocationStrategy)strategy);
+    }
+    printf("test_snapshot: ok\n");
+    return 0;
+}
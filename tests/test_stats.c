@@ -0,0 +1,133 @@
+// Contadores incrementais: mymemory_get_stats precisa concordar com o percurso do pool (mymemory_walk)
+// e com os blocos vivos em todas as estratégias, sem que as estatísticas percorram a lista de blocos
+#include <string.h>
+#include "mymemory.h"
+#include "check.h"
+
+#define POOL_SIZE (1 << 20)
+#define LIVE 512  // Blocos vivos no máximo
+#define ROUNDS 20000  // Operações aleatórias por estratégia
+
+typedef struct {
+    char *next;  // Onde o próximo trecho precisa começar
+    size_t used;  // Bytes em trechos alocados
+    size_t free;  // Bytes em trechos livres
+    size_t largest;  // Maior trecho livre
+    size_t free_extents;
+} walk_t;
+
+static int walk_extent(const mymemory_extent_t *extent, void *context)
+{
+    walk_t *walk = (walk_t *)context;
+    CHECK((char *)extent->start == walk->next);  // Trechos contíguos, em ordem de endereços
+    if (extent->is_free)
+    {
+        walk->free += extent->size;
+        walk->free_extents++;
+        if (extent->size > walk->largest)
+        {
+            walk->largest = extent->size;
+        }
+    }
+    else
+    {
+        walk->used += extent->size;
+    }
+    walk->next = (char *)extent->start + extent->size;
+    return 0;
+}
+
+// Percorre o pool e confere o percurso contra as estatísticas
+static mymemory_stats_t check_pool(mymemory_t *memory, AllocationStrategy strategy)
+{
+    walk_t walk = { (char *)memory->pool, 0, 0, 0, 0 };
+    CHECK(mymemory_walk(memory, walk_extent, &walk) == 0);
+    CHECK(walk.next == (char *)memory->pool + memory->total_size);  // O percurso cobre o pool inteiro
+
+    mymemory_stats_t stats = mymemory_get_stats(memory);
+    CHECK(walk.used == stats.bytes_in_use);
+    CHECK(stats.bytes_in_use + stats.bytes_free == stats.total_size);
+    CHECK(stats.peak_bytes_in_use >= stats.bytes_in_use);
+    if (strategy <= SEGREGATED_FIT) // Estratégias com descritores: cada trecho livre é um bloco livre
+    {
+        CHECK(walk.free == stats.bytes_free);
+        CHECK(walk.free_extents == stats.free_blocks);
+        CHECK(walk.largest == stats.largest_free_block);
+    }
+    return stats;
+}
+
+static void run(AllocationStrategy strategy)
+{
+    mymemory_t *memory = mymemory_init_config(POOL_SIZE, strategy, NULL);
+    char *live[LIVE] = { NULL };
+    unsigned seed = 1234u + (unsigned)strategy;
+    size_t count = 0, peak = 0, failed = 0;
+
+    CHECK(memory);
+    check_pool(memory, strategy);
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        int k = rand_r(&seed) % LIVE;
+        if (!live[k])
+        {
+            size_t size = rand_r(&seed) % 8 ? 1 + rand_r(&seed) % 256 : 1 + rand_r(&seed) % 8192;
+            live[k] = (char *)mymemory_alloc(memory, size);
+            count += live[k] != NULL;
+            failed += live[k] == NULL;
+        }
+        else if (strategy != ARENA)
+        {
+            mymemory_free(memory, live[k]);
+            live[k] = NULL;
+            count--;
+        }
+
+        mymemory_stats_t stats = mymemory_get_stats(memory);
+        peak = stats.bytes_in_use > peak ? stats.bytes_in_use : peak;
+        CHECK(stats.peak_bytes_in_use == peak);
+        CHECK(stats.failed_allocations == failed);
+        CHECK(stats.allocated_blocks == count);  // Na arena só cresce até o reset
+        if (round % 97 == 0)
+        {
+            check_pool(memory, strategy);
+        }
+    }
+
+    for (int i = 0; i < LIVE; i++) // Tudo volta ao pool
+    {
+        if (live[i] && strategy != ARENA)
+        {
+            mymemory_free(memory, live[i]);
+        }
+    }
+    if (strategy == ARENA)
+    {
+        mymemory_reset(memory);  // Na arena os objetos só voltam todos juntos
+    }
+    mymemory_stats_t stats = check_pool(memory, strategy);
+    CHECK(stats.bytes_in_use == 0);
+    CHECK(stats.allocated_blocks == 0);
+    CHECK(stats.peak_bytes_in_use == peak);  // O pico sobrevive às liberações
+    if (strategy <= ARENA) // Sem blocos alocados, um único trecho livre cobre o pool
+    {
+        CHECK(stats.free_blocks == 1);
+        CHECK(stats.largest_free_block == POOL_SIZE);
+    }
+
+    while (mymemory_alloc(memory, 4096)) // Enche o pool: a primeira falta de espaço conta como falha
+    {
+    }
+    CHECK(mymemory_get_stats(memory).failed_allocations == failed + 1);
+    mymemory_cleanup(memory);
+}
+
+int main(void)
+{
+    for (int strategy = FIRST_FIT; strategy <= BUDDY; strategy++)
+    {
+        run((AllocationStrategy)strategy);
+    }
+    printf("test_stats: ok\n");
+    return 0;
+}
@@ -0,0 +1,149 @@
+// Modo concorrente: várias threads alocando e liberando blocos umas das outras (caches por thread e pilhas remotas)
+// Cada bloco vivo guarda uma marca única; se dois blocos vivos recebessem o mesmo endereço, uma marca seria sobrescrita
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include "mymemory.h"
+#include "check.h"
+
+#define THREADS 4
+#define SLOTS 128  // Blocos vivos por thread
+#define EXCHANGE 256  // Posições da área de troca entre threads
+#define OPERATIONS 100000  // Operações por thread
+
+typedef struct {
+    mymemory_t *memory;
+    _Atomic(uint64_t *) *exchange;  // Blocos deixados para outra thread liberar
+    unsigned seed;
+    uint64_t id;  // Prefixo das marcas desta thread
+} worker_t;
+
+// Confere a marca do bloco e o libera
+static void release(mymemory_t *memory, uint64_t *block)
+{
+    CHECK(block[1] == ~block[0]);  // A marca ainda é a que o dono gravou
+    mymemory_free(memory, block);
+}
+
+static void *worker(void *arg)
+{
+    worker_t *work = (worker_t *)arg;
+    uint64_t *slots[SLOTS] = { NULL };
+    uint64_t serial = 0;
+
+    for (int i = 0; i < OPERATIONS; i++)
+    {
+        int k = rand_r(&work->seed) % SLOTS;
+        if (slots[k])
+        {
+            uint64_t *block = slots[k];
+            slots[k] = NULL;
+            if (rand_r(&work->seed) % 4 == 0) // Deixa o bloco para outra thread e libera o que estava na troca
+            {
+                block = atomic_exchange(&work->exchange[rand_r(&work->seed) % EXCHANGE], block);
+            }
+            if (block)
+            {
+                release(work->memory, block);
+            }
+        }
+        else
+        {
+            size_t size = 16 + rand_r(&work->seed) % (rand_r(&work->seed) % 16 ? 240 : 4080);
+            slots[k] = (uint64_t *)mymemory_alloc(work->memory, size);
+            CHECK(slots[k]);
+            slots[k][0] = work->id << 32 | serial++;
+            slots[k][1] = ~slots[k][0];
+        }
+    }
+    for (int k = 0; k < SLOTS; k++)
+    {
+        if (slots[k])
+        {
+            release(work->memory, slots[k]);
+        }
+    }
+    return NULL;
+}
+
+static void run(AllocationStrategy strategy)
+{
+    mymemory_config_t config = { 0 };
+    config.concurrent = 1;
+    mymemory_t *memory = mymemory_init_config(32 << 20, strategy, &config);
+    _Atomic(uint64_t *) exchange[EXCHANGE];
+    pthread_t threads[THREADS];
+    worker_t work[THREADS];
+
+    CHECK(memory);
+    for (int i = 0; i < EXCHANGE; i++)
+    {
+        atomic_init(&exchange[i], NULL);
+    }
+    for (int t = 0; t < THREADS; t++)
+    {
+        work[t].memory = memory;
+        work[t].exchange = exchange;
+        work[t].seed = 77u * (unsigned)(t + 1) + (unsigned)strategy;
+        work[t].id = (uint64_t)t + 1;
+        CHECK(pthread_create(&threads[t], NULL, worker, &work[t]) == 0);
+    }
+    for (int t = 0; t < THREADS; t++)
+    {
+        pthread_join(threads[t], NULL);
+    }
+    for (int i = 0; i < EXCHANGE; i++)
+    {
+        uint64_t *block = atomic_load(&exchange[i]);
+        if (block)
+        {
+            release(memory, block);
+        }
+    }
+
+    mymemory_stats_t stats = mymemory_get_stats(memory);
+    CHECK(stats.failed_allocations == 0);
+    CHECK(stats.bytes_in_use <= stats.total_size);
+    mymemory_reset(memory);  // Os caches de thread ainda guardam blocos: o reset devolve tudo
+    stats = mymemory_get_stats(memory);
+    CHECK(stats.bytes_in_use == 0);
+    CHECK(stats.allocated_blocks == 0);
+    mymemory_cleanup(memory);
+}
+
+// Liberação dupla de um bloco que já está em um cache de thread: o endereço não pode ser entregue duas vezes
+static void cached_double_free(AllocationStrategy strategy)
+{
+    mymemory_config_t config = { 0 };
+    config.concurrent = 1;
+    mymemory_t *memory = mymemory_init_config(1 << 20, strategy, &config);
+
+    CHECK(memory);
+    void *ptr = mymemory_alloc(memory, 32);
+    CHECK(ptr);
+    mymemory_free(memory, ptr);
+    mymemory_free(memory, ptr);
+    void *first = mymemory_alloc(memory, 32);
+    void *second = mymemory_alloc(memory, 32);
+    CHECK(first && second && first != second);
+    mymemory_cleanup(memory);
+}
+
+int main(void)
+{
+    for (int strategy = FIRST_FIT; strategy <= BUDDY; strategy++)
+    {
+        if (strategy == ARENA) // A arena não libera objetos individualmente
+        {
+            continue;
+        }
+        run((AllocationStrategy)strategy);
+    }
+    for (int strategy = FIRST_FIT; strategy <= SEGREGATED_FIT; strategy++)
+    {
+        cached_double_free((AllocationStrategy)strategy);
+    }
+    printf("test_threads: ok\n");
+    return 0;
+}